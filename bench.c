@@ -0,0 +1,701 @@
+/**
+ * Benchmarks for the Naegele's rule library. Prints one JSON document to stdout so results can
+ * be stored and compared between builds.
+ *
+ * Micro benchmarks time each public function in ns/op over a synthetic dataset of LNMPs spread
+ * evenly over 1900-2100 (plus a share of malformed strings); macro benchmarks time the batch
+ * API and, given --cli, the streaming CLI over a generated file and the binary-protocol server
+ * over a Unix socket. Server results report per-request latency percentiles (p50_us, p99_us):
+ * one with a single request in flight and one with BENCH_SERVER_DEPTH pipelined requests.
+ *
+ * Usage: bench [--rows N] [--invalid PERCENT] [--threads N] [--cli PATH]
+ */
+#define _POSIX_C_SOURCE 200809L  // for clock_gettime, mkstemp, mkdtemp, kill
+
+#include "edd.h"
+#include "edd_server.h"
+
+#include <stdbool.h>     // for bool, true, false
+#include <stddef.h>      // for size_t
+#include <stdint.h>      // for int32_t, uint8_t, uint64_t
+#include <stdio.h>       // for printf, fprintf, snprintf, fopen
+#include <stdlib.h>      // for malloc, free, strtoul, mkstemp, mkdtemp, system, qsort
+#include <signal.h>      // for kill, SIGTERM
+#include <string.h>      // for strcmp, strlen, memcpy, memmove
+#include <sys/socket.h>  // for socket, connect, AF_UNIX
+#include <sys/un.h>      // for struct sockaddr_un
+#include <sys/wait.h>    // for waitpid
+#include <time.h>        // for clock_gettime, nanosleep, struct timespec
+#include <unistd.h>      // for close, unlink, rmdir, fork, execl, read, write
+
+/** Default number of rows in the synthetic dataset. */
+#define BENCH_DEFAULT_ROWS 1000000
+
+/** Minimum wall time per measured run; short runs are repeated until they reach it. */
+#define BENCH_MIN_SECONDS 0.2
+
+/** Measured runs per benchmark; the fastest is reported. */
+#define BENCH_RUNS 5
+
+/** Reference date for every WOA computation (01/06/2024), so runs are reproducible. */
+#define BENCH_AS_OF 19875
+
+/** Days before BENCH_AS_OF that the clustered dataset's LNMPs fall in (about ten months). */
+#define BENCH_CLUSTER_DAYS 300
+
+/** Requests per server latency run (fewer if the dataset is smaller). */
+#define BENCH_SERVER_REQUESTS 200000
+
+/** Requests kept in flight by the pipelined server latency run. */
+#define BENCH_SERVER_DEPTH 32
+
+/** Synthetic inputs shared by every benchmark. */
+typedef struct {
+    size_t rows;
+    char* text;       /**< rows fixed-width records of DATE_STR_MAX_LEN bytes, NUL-terminated. */
+    int32_t* lnmp;    /**< Day number of each row; invalid rows are outside the valid range. */
+    int32_t* recent;  /**< lnmp folded into the BENCH_CLUSTER_DAYS before BENCH_AS_OF. */
+    int32_t* civil;   /**< Day, month and year of each row, three ints per row. */
+    uint8_t* method;  /**< Dating method of each row, cycling through every method. */
+    uint8_t* param;   /**< Method parameter of each row, valid for its method. */
+    int32_t* edd;     /**< Batch output arrays. */
+    int32_t* weeks;
+    int32_t* days;
+    int32_t* status;
+    unsigned threads; /**< Threads for the parallel batch benchmark. */
+} bench_data_t;
+
+/** A benchmark body: runs one pass over the dataset and returns a checksum. */
+typedef uint64_t (*bench_fn)(const bench_data_t* data);
+
+/** Sink for checksums, so the compiler cannot drop the measured work. */
+static volatile uint64_t bench_sink;
+
+/** Tracks whether a JSON separator is needed before the next result. */
+static bool bench_first_result = true;
+
+/**
+ * Returns a monotonic timestamp in seconds.
+ * @return Seconds since an arbitrary epoch.
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Returns the next value of a xorshift64 generator, so datasets are identical between runs.
+ * @param state Generator state (non-zero).
+ * @return Pseudo-random value.
+ */
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Fills the dataset: valid LNMPs spread over 1900-2100, with invalid_percent of the rows
+ * replaced by impossible dates or malformed strings.
+ * @param data Dataset with rows set and arrays allocated.
+ * @param invalid_percent Share of invalid rows (0-100).
+ */
+static void fill_dataset(bench_data_t* data, unsigned invalid_percent) {
+    static const char* const malformed[] = {"31/02/2024", "1/1/2024", "00/13/1999", "",
+                                            "2024-01-01", "15/06/2101", "ab/cd/efgh"};
+    static const uint8_t params[NAEGELES_METHOD_COUNT] = {0, 30, 1, 0, 5, 45, 50};
+    int32_t first = 0, last = 0;
+    naegeles_date_to_days(1, 1, 1900, &first);
+    naegeles_date_to_days(31, 12, 2100, &last);
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < data->rows; i++) {
+        char* record    = data->text + i * DATE_STR_MAX_LEN;
+        data->method[i] = (uint8_t)(i % NAEGELES_METHOD_COUNT);
+        data->param[i]  = params[data->method[i]];
+        if (next_random(&state) % 100 < invalid_percent) {
+            size_t pick     = next_random(&state) % (sizeof(malformed) / sizeof(*malformed));
+            const char* bad = malformed[pick];
+            snprintf(record, DATE_STR_MAX_LEN, "%s", bad);
+            data->lnmp[i]          = INT32_MIN;
+            data->recent[i]        = INT32_MIN;
+            data->civil[3 * i]     = 31;
+            data->civil[3 * i + 1] = 2;
+            data->civil[3 * i + 2] = 2024;
+            continue;
+        }
+
+        int32_t days = first + (int32_t)(next_random(&state) % (uint64_t)(last - first + 1));
+        int day = 0, month = 0, year = 0;
+        naegeles_days_to_date(days, &day, &month, &year);
+        snprintf(record, DATE_STR_MAX_LEN, "%02d/%02d/%04d", day, month, year);
+        data->lnmp[i]          = days;
+        data->recent[i]        = BENCH_AS_OF - (days - first) % BENCH_CLUSTER_DAYS;
+        data->civil[3 * i]     = day;
+        data->civil[3 * i + 1] = month;
+        data->civil[3 * i + 2] = year;
+    }
+}
+
+// Benchmark bodies: each runs one pass of a public function over every row (bench_fn).
+
+static uint64_t bench_parse_date(const bench_data_t* data) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < data->rows; i++) {
+        int32_t days = 0;
+        sum += (uint64_t)naegeles_parse_date(data->text + i * DATE_STR_MAX_LEN, &days);
+        sum += (uint64_t)days;
+    }
+    return sum;
+}
+
+static uint64_t bench_parse_batch(const bench_data_t* data) {
+    naegeles_parse_batch(data->text, DATE_STR_MAX_LEN, data->rows, data->edd, data->status);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+static uint64_t bench_date_to_days(const bench_data_t* data) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < data->rows; i++) {
+        const int32_t* civil = data->civil + 3 * i;
+        int32_t days         = 0;
+        sum += (uint64_t)naegeles_date_to_days(civil[0], civil[1], civil[2], &days);
+        sum += (uint64_t)days;
+    }
+    return sum;
+}
+
+static uint64_t bench_days_to_date(const bench_data_t* data) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < data->rows; i++) {
+        int day = 0, month = 0, year = 0;
+        naegeles_days_to_date(data->lnmp[i], &day, &month, &year);
+        sum += (uint64_t)(day + month + year);
+    }
+    return sum;
+}
+
+static uint64_t bench_format_date(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char out[DATE_STR_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        sum += (uint64_t)naegeles_format_date(data->lnmp[i] + 280, out, sizeof(out));
+        sum += (uint64_t)out[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_format_woa(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char out[WOA_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        int32_t lnmp  = data->lnmp[i] == INT32_MIN ? BENCH_AS_OF : data->lnmp[i];  // Malformed row
+        int32_t total = BENCH_AS_OF > lnmp ? BENCH_AS_OF - lnmp : lnmp - BENCH_AS_OF;
+        sum += (uint64_t)naegeles_format_woa(total / 7, total % 7, out, sizeof(out));
+        sum += (uint64_t)out[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_edd(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char edd[DATE_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        const char* lnmp = data->text + i * DATE_STR_MAX_LEN;
+        sum += (uint64_t)naegeles_compute_edd(lnmp, edd, sizeof(edd));
+        sum += (uint64_t)edd[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_woa_asof(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char woa[WOA_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        const char* lnmp = data->text + i * DATE_STR_MAX_LEN;
+        sum += (uint64_t)naegeles_compute_woa_asof(lnmp, BENCH_AS_OF, woa, sizeof(woa));
+        sum += (uint64_t)woa[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_woa(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char woa[WOA_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        const char* lnmp = data->text + i * DATE_STR_MAX_LEN;
+        sum += (uint64_t)naegeles_compute_woa(lnmp, woa, sizeof(woa));
+        sum += (uint64_t)woa[0];
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_asof(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char edd[DATE_STR_MAX_LEN];
+    char woa[WOA_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        const char* lnmp = data->text + i * DATE_STR_MAX_LEN;
+        sum += (uint64_t)naegeles_compute_asof(lnmp, BENCH_AS_OF, edd, sizeof(edd), woa,
+                                               sizeof(woa));
+        sum += (uint64_t)(edd[0] + woa[0]);
+    }
+    return sum;
+}
+
+static uint64_t bench_compute(const bench_data_t* data) {
+    uint64_t sum = 0;
+    char edd[DATE_STR_MAX_LEN];
+    char woa[WOA_STR_MAX_LEN];
+    for (size_t i = 0; i < data->rows; i++) {
+        const char* lnmp = data->text + i * DATE_STR_MAX_LEN;
+        sum += (uint64_t)naegeles_compute(lnmp, edd, sizeof(edd), woa, sizeof(woa));
+        sum += (uint64_t)(edd[0] + woa[0]);
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_result_asof(const bench_data_t* data) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < data->rows; i++) {
+        naegeles_result_t result = {0};
+        naegeles_compute_result_asof(data->text + i * DATE_STR_MAX_LEN, BENCH_AS_OF, &result);
+        sum += (uint64_t)(result.edd_day + result.woa_weeks);
+    }
+    return sum;
+}
+
+static uint64_t bench_compute_batch_ctx(const bench_data_t* data) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, BENCH_AS_OF);
+    const naegeles_batch_t out = {data->edd, data->weeks, data->days, data->status};
+    naegeles_compute_batch_ctx(&ctx, data->lnmp, data->rows, &out);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+static uint64_t bench_compute_batch_ctx_clustered(const bench_data_t* data) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, BENCH_AS_OF);
+    const naegeles_batch_t out = {data->edd, data->weeks, data->days, data->status};
+    naegeles_compute_batch_ctx(&ctx, data->recent, data->rows, &out);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+static uint64_t bench_compute_batch_dedup_clustered(const bench_data_t* data) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, BENCH_AS_OF);
+    const naegeles_batch_t out = {data->edd, data->weeks, data->days, data->status};
+    naegeles_compute_batch_dedup(&ctx, data->recent, data->rows, &out);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+static uint64_t bench_compute_batch_methods(const bench_data_t* data) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, BENCH_AS_OF);
+    const naegeles_batch_t out = {data->edd, data->weeks, data->days, data->status};
+    naegeles_compute_batch_methods(&ctx, data->recent, data->method, data->param, data->rows,
+                                   &out);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+static uint64_t bench_compute_batch_parallel(const bench_data_t* data) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, BENCH_AS_OF);
+    const naegeles_batch_t out = {data->edd, data->weeks, data->days, data->status};
+    naegeles_compute_batch_parallel(&ctx, data->lnmp, data->rows, &out, data->threads);
+    return (uint64_t)data->edd[data->rows - 1];
+}
+
+/**
+ * Prints one result object.
+ * @param name Benchmark name.
+ * @param kind "micro" or "macro".
+ * @param ops Operations (rows) per pass.
+ * @param seconds Best time per pass.
+ */
+static void print_result(const char* name, const char* kind, size_t ops, double seconds) {
+    printf("%s\n    {\"name\": \"%s\", \"kind\": \"%s\", \"ops\": %zu, \"seconds\": %.6f, "
+           "\"ns_per_op\": %.3f, \"mops_per_s\": %.3f}",
+           bench_first_result ? "" : ",", name, kind, ops, seconds, seconds * 1e9 / (double)ops,
+           (double)ops / seconds * 1e-6);
+    bench_first_result = false;
+}
+
+/**
+ * Times a benchmark: each measured run repeats the pass until BENCH_MIN_SECONDS have elapsed,
+ * and the fastest of BENCH_RUNS runs is reported per pass.
+ * @param name Benchmark name.
+ * @param kind "micro" or "macro".
+ * @param fn Benchmark body.
+ * @param data Dataset.
+ */
+static void run_bench(const char* name, const char* kind, bench_fn fn, const bench_data_t* data) {
+    bench_sink += fn(data);  // Warm-up
+
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        size_t passes  = 0;
+        double start   = now_seconds();
+        double elapsed = 0.0;
+        do {
+            bench_sink += fn(data);
+            passes++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+
+        if (elapsed / (double)passes < best) {
+            best = elapsed / (double)passes;
+        }
+    }
+
+    print_result(name, kind, data->rows, best);
+}
+
+/**
+ * Times the streaming CLI over the dataset written one LNMP per line to a temporary file.
+ * @param cli Path to the edd binary.
+ * @param data Dataset.
+ * @param threads Value for --threads.
+ * @return true on success, false if the file could not be written or the CLI failed.
+ */
+static bool run_stream_bench(const char* cli, const bench_data_t* data, unsigned threads) {
+    char path[] = "/tmp/edd-bench-XXXXXX";
+    int fd      = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+
+    FILE* file = fopen(path, "w");
+    bool ok    = file != NULL;
+    for (size_t i = 0; ok && i < data->rows; i++) {
+        ok = fprintf(file, "%s\n", data->text + i * DATE_STR_MAX_LEN) >= 0;
+    }
+    ok = file != NULL && fclose(file) == 0 && ok;
+
+    char command[512];
+    snprintf(command, sizeof(command),
+             "'%s' --stream --as-of 01/06/2024 --threads %u '%s' >/dev/null", cli, threads, path);
+
+    double best = 1e30;
+    for (int run = 0; ok && run < BENCH_RUNS; run++) {
+        double start   = now_seconds();
+        ok             = system(command) == 0;
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    unlink(path);
+    if (ok) {
+        char name[64];
+        snprintf(name, sizeof(name), "stream_threads_%u", threads);
+        print_result(name, "macro", data->rows, best);
+    }
+    return ok;
+}
+
+/**
+ * Stores a little-endian int32, the server protocol's integer encoding.
+ * @param p Destination (4 bytes).
+ * @param value Value to store.
+ */
+static void store_le32(unsigned char* p, int32_t value) {
+    uint32_t bits = (uint32_t)value;
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(bits >> (8 * i));
+    }
+}
+
+/**
+ * Orders two doubles for qsort.
+ * @param a First value.
+ * @param b Second value.
+ * @return Negative, zero or positive as *a is below, equal to or above *b.
+ */
+static int compare_doubles(const void* a, const void* b) {
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Connects to a Unix socket, retrying for up to two seconds while the server starts.
+ * @param path Socket path.
+ * @return Connected socket, or -1 on failure.
+ */
+static int connect_unix(const char* path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    const struct timespec pause = {0, 10 * 1000 * 1000};
+    for (int attempt = 0; attempt < 200; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (const struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            return fd;
+        }
+        close(fd);
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+/**
+ * Sends count requests keeping at most depth in flight, and records each one's latency from
+ * the write that sent it to the read that completed its response.
+ * @param fd Connected server socket.
+ * @param requests count packed requests.
+ * @param count Number of requests.
+ * @param depth Maximum requests in flight (1 to BENCH_SERVER_DEPTH).
+ * @param latency Output latency of each request in seconds, count elements.
+ * @param seconds Output wall time of the whole run.
+ * @return true on success, false on a socket error or a short response stream.
+ */
+static bool server_run(int fd, const unsigned char* requests, size_t count, size_t depth,
+                       double* latency, double* seconds) {
+    unsigned char response[BENCH_SERVER_DEPTH * NAEGELES_SERVER_RESPONSE_SIZE];
+    double sent_at[BENCH_SERVER_DEPTH];
+    size_t sent = 0, done = 0, partial = 0;
+
+    const double start = now_seconds();
+    while (done < count) {
+        // Top the window up in one write; every request in it shares the send time
+        size_t batch = depth - (sent - done);
+        batch        = batch < count - sent ? batch : count - sent;
+        if (batch > 0) {
+            const double now = now_seconds();
+            for (size_t i = 0; i < batch; i++) {
+                sent_at[(sent + i) % BENCH_SERVER_DEPTH] = now;
+            }
+            const unsigned char* p = requests + sent * NAEGELES_SERVER_REQUEST_SIZE;
+            size_t left            = batch * NAEGELES_SERVER_REQUEST_SIZE;
+            while (left > 0) {
+                ssize_t n = write(fd, p, left);
+                if (n <= 0) {
+                    return false;
+                }
+                p += n;
+                left -= (size_t)n;
+            }
+            sent += batch;
+        }
+
+        const size_t want = (sent - done) * NAEGELES_SERVER_RESPONSE_SIZE - partial;
+        ssize_t n         = read(fd, response + partial, want);
+        if (n <= 0) {
+            return false;
+        }
+        const double now   = now_seconds();
+        const size_t total = partial + (size_t)n;
+        const size_t whole = total / NAEGELES_SERVER_RESPONSE_SIZE;
+        for (size_t i = 0; i < whole; i++, done++) {
+            latency[done] = now - sent_at[done % BENCH_SERVER_DEPTH];
+        }
+        // Responses are only consumed whole; keep the bytes of a split one
+        partial = total - whole * NAEGELES_SERVER_RESPONSE_SIZE;
+        memmove(response, response + whole * NAEGELES_SERVER_RESPONSE_SIZE, partial);
+    }
+    *seconds = now_seconds() - start;
+    return true;
+}
+
+/**
+ * Times the binary-protocol server: starts `cli --serve unix:PATH --threads 1`, then reports
+ * per-request latency with one request in flight and with BENCH_SERVER_DEPTH pipelined.
+ * @param cli Path to the edd binary.
+ * @param data Dataset; the LNMP day numbers are the requests, all as of BENCH_AS_OF.
+ * @return true on success, false if the server could not be started or reached.
+ */
+static bool run_server_bench(const char* cli, const bench_data_t* data) {
+    const size_t count = data->rows < BENCH_SERVER_REQUESTS ? data->rows : BENCH_SERVER_REQUESTS;
+    unsigned char* requests = malloc(count * NAEGELES_SERVER_REQUEST_SIZE);
+    double* latency         = malloc(count * sizeof(double));
+    char dir[]              = "/tmp/edd-bench-XXXXXX";
+    if (requests == NULL || latency == NULL || mkdtemp(dir) == NULL) {
+        free(requests);
+        free(latency);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        store_le32(requests + i * NAEGELES_SERVER_REQUEST_SIZE, data->lnmp[i]);
+        store_le32(requests + i * NAEGELES_SERVER_REQUEST_SIZE + 4, BENCH_AS_OF);
+    }
+
+    char path[64], address[80];
+    snprintf(path, sizeof(path), "%s/edd.sock", dir);
+    snprintf(address, sizeof(address), "unix:%s", path);
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        execl(cli, cli, "--serve", address, "--threads", "1", (char*)NULL);
+        _exit(127);
+    }
+
+    static const size_t depths[] = {1, BENCH_SERVER_DEPTH};
+    const int fd                 = pid > 0 ? connect_unix(path) : -1;
+    bool ok                      = fd >= 0;
+    for (size_t d = 0; ok && d < sizeof(depths) / sizeof(depths[0]); d++) {
+        const size_t depth = depths[d];
+        double best = 1e30, seconds = 0.0;
+        ok = server_run(fd, requests, count, depth, latency, &seconds);  // Warm-up
+        for (int run = 0; ok && run < BENCH_RUNS; run++) {
+            ok   = server_run(fd, requests, count, depth, latency, &seconds);
+            best = seconds < best ? seconds : best;
+        }
+        if (!ok) {
+            break;
+        }
+
+        // Percentiles come from the last run
+        qsort(latency, count, sizeof(double), compare_doubles);
+        char name[64];
+        snprintf(name, sizeof(name), "server_unix_depth_%zu", depth);
+        print_result(name, "macro", count, best);
+        printf(",\n    {\"name\": \"%s_latency\", \"kind\": \"latency\", \"ops\": %zu, "
+               "\"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f}",
+               name, count, latency[count / 2] * 1e6, latency[count * 99 / 100] * 1e6,
+               latency[count - 1] * 1e6);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+    unlink(path);
+    rmdir(dir);
+    free(requests);
+    free(latency);
+    return ok;
+}
+
+/**
+ * Prints usage information.
+ * @param prog Program name.
+ */
+static void print_usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--rows N] [--invalid PERCENT] [--threads N] [--cli PATH]\n", prog);
+    fprintf(stderr, "  --rows N           Rows in the synthetic dataset (default %d)\n",
+            BENCH_DEFAULT_ROWS);
+    fprintf(stderr, "  --invalid PERCENT  Share of invalid rows (default 0)\n");
+    fprintf(stderr, "  --threads N        Threads for the parallel benchmarks (0 = one per CPU)\n");
+    fprintf(stderr, "  --cli PATH         Also time streaming and server modes of the edd binary\n"
+            "                     at PATH\n");
+}
+
+/**
+ * Entry point: builds the dataset, runs every benchmark and prints the JSON report.
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return 0 on success, 1 on error.
+ */
+int main(int argc, char* argv[]) {
+    bench_data_t data        = {.rows = BENCH_DEFAULT_ROWS};
+    unsigned invalid_percent = 0;
+    const char* cli          = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        char* end = NULL;
+        if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            data.rows = strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--invalid") == 0 && i + 1 < argc) {
+            invalid_percent = (unsigned)strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            data.threads = (unsigned)strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--cli") == 0 && i + 1 < argc) {
+            cli = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        if (end != NULL && *end != '\0') {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (data.rows == 0 || invalid_percent > 100) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    data.text   = malloc(data.rows * DATE_STR_MAX_LEN);
+    data.lnmp   = malloc(data.rows * sizeof(int32_t));
+    data.recent = malloc(data.rows * sizeof(int32_t));
+    data.civil  = malloc(data.rows * 3 * sizeof(int32_t));
+    data.method = malloc(data.rows);
+    data.param  = malloc(data.rows);
+    data.edd    = malloc(data.rows * sizeof(int32_t));
+    data.weeks  = malloc(data.rows * sizeof(int32_t));
+    data.days   = malloc(data.rows * sizeof(int32_t));
+    data.status = malloc(data.rows * sizeof(int32_t));
+    if (data.text == NULL || data.lnmp == NULL || data.recent == NULL ||
+        data.civil == NULL || data.method == NULL || data.param == NULL || data.edd == NULL ||
+        data.weeks == NULL || data.days == NULL || data.status == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        return 1;
+    }
+
+    fill_dataset(&data, invalid_percent);
+
+    printf("{\n  \"benchmark\": \"edd\",\n  \"rows\": %zu,\n  \"invalid_percent\": %u,\n"
+           "  \"threads\": %u,\n  \"results\": [",
+           data.rows, invalid_percent, data.threads);
+
+    run_bench("naegeles_parse_date", "micro", bench_parse_date, &data);
+    run_bench("naegeles_date_to_days", "micro", bench_date_to_days, &data);
+    run_bench("naegeles_days_to_date", "micro", bench_days_to_date, &data);
+    run_bench("naegeles_format_date", "micro", bench_format_date, &data);
+    run_bench("naegeles_format_woa", "micro", bench_format_woa, &data);
+    run_bench("naegeles_compute_edd", "micro", bench_compute_edd, &data);
+    run_bench("naegeles_compute_woa_asof", "micro", bench_compute_woa_asof, &data);
+    run_bench("naegeles_compute_woa", "micro", bench_compute_woa, &data);
+    run_bench("naegeles_compute_asof", "micro", bench_compute_asof, &data);
+    run_bench("naegeles_compute", "micro", bench_compute, &data);
+    run_bench("naegeles_compute_result_asof", "micro", bench_compute_result_asof, &data);
+    run_bench("naegeles_parse_batch", "macro", bench_parse_batch, &data);
+    run_bench("naegeles_compute_batch_ctx", "macro", bench_compute_batch_ctx, &data);
+    run_bench("naegeles_compute_batch_parallel", "macro", bench_compute_batch_parallel, &data);
+    run_bench("naegeles_compute_batch_ctx_clustered", "macro", bench_compute_batch_ctx_clustered,
+              &data);
+    run_bench("naegeles_compute_batch_dedup_clustered", "macro",
+              bench_compute_batch_dedup_clustered, &data);
+    run_bench("naegeles_compute_batch_methods", "macro", bench_compute_batch_methods, &data);
+
+    const char* failed = NULL;
+    if (cli != NULL) {
+        if (!run_stream_bench(cli, &data, 1) ||
+            (data.threads != 1 && !run_stream_bench(cli, &data, data.threads))) {
+            failed = "streaming";
+        } else if (!run_server_bench(cli, &data)) {
+            failed = "server";
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    free(data.text);
+    free(data.lnmp);
+    free(data.recent);
+    free(data.civil);
+    free(data.method);
+    free(data.param);
+    free(data.edd);
+    free(data.weeks);
+    free(data.days);
+    free(data.status);
+
+    if (failed != NULL) {
+        fprintf(stderr, "Error: %s benchmark failed\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -1,16 +1,94 @@
 #!/usr/bin/env bash
+#
+# Usage: ./build.sh [single|lib|cli|test|bench|fuzz]
+#   single  (default) edd.js only, with the WASM binary embedded as base64 (SINGLE_FILE). The
+#           checked-in edd.js, which index.html and bench.html load, was built with these flags
+#           from an earlier edd.c; rebuild and commit it to bring the page up to date.
+#   lib     libedd.a and libedd.so for embedding, with edd.h (and edd_arrow.h for the Arrow C Data
+#           Interface bindings) as public headers. The static library keeps LTO bytecode, so a
+#           consumer linking with -flto gets cross-TU inlining.
+#   cli     the edd command-line tool (edd_cli.c and edd_server.c linked against edd.c).
+#   test    edd_verify, the self-check (edd_verify.c and edd_verify_hpp.cpp linked against edd.c
+#           and edd_arrow.c); ./edd_verify checks every fast path, edd.hpp and the Arrow
+#           bindings against a reference implementation and exits with 1 on any mismatch.
+#   bench   the native bench binary and the edd tool it times; run ./bench --cli ./edd for a JSON
+#           report. bench.html gives per-call timings for calculator.js over edd.js.
+#   fuzz    edd_fuzz, a libFuzzer target for the date parsers built with clang (or $CC) under
+#           ASan and UBSan; run e.g. ./edd_fuzz -fork=$(nproc) -max_total_time=60.
+#
+# Extra compiler flags can be passed through CFLAGS, e.g. CFLAGS=-DNAEGELES_EDD_LUT ./build.sh
+# to build edd.c with its precomputed EDD table. The native modes use $CC (default cc), and test
+# uses $CXX (default c++) with CXXFLAGS for the C++ part of the self-check.
+set -euo pipefail
 
-# Initialize emscripten environment
-export EMSDK_QUIET=1
-source "$HOME/emscripten/emsdk-portable/emsdk_env.sh"
+mode="${1:-single}"
+cc="${CC:-cc}"
 
-# Compile the c file and build a wasm module bundles with Javascript and loading helpers.
-emcc -std=c23 -DWASM_BUILD \
-     -s EXPORTED_FUNCTIONS='["_naegeles_compute_edd","_naegeles_compute_woa","_naegeles_compute","_naegeles_error_string"]' \
-     -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","stackSave","stackAlloc","UTF8ToString","stackRestore"]' \
-     -s ENVIRONMENT=web \
-     -s SINGLE_FILE=1 \
-     -s MODULARIZE=1 \
-     -s EXPORT_NAME='createNaegelesModule' \
-     -o edd.js \
-     edd.c
+# Initializes the emscripten environment
+load_emsdk() {
+     export EMSDK_QUIET=1
+     source "$HOME/emscripten/emsdk-portable/emsdk_env.sh"
+}
+
+# Flags for the WASM build, matching the checked-in edd.js.
+wasm_flags=(
+     -std=c23 -DWASM_BUILD ${CFLAGS:-}
+     -s EXPORTED_FUNCTIONS='["_naegeles_compute_edd","_naegeles_compute_woa","_naegeles_compute","_naegeles_error_string"]'
+     -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","stackSave","stackAlloc","UTF8ToString","stackRestore"]'
+     -s ENVIRONMENT=web
+     -s MODULARIZE=1
+     -s EXPORT_NAME='createNaegelesModule'
+)
+
+# Flags shared by the native modes.
+native_flags=(-std=c2x -O3 -flto=auto -Wall -Wextra ${CFLAGS:-})
+
+# Flags for edd_verify_hpp.cpp, which needs no C++ runtime, so the C driver can link it.
+native_cxx_flags=(-std=c++17 -O3 -Wall -Wextra -fno-exceptions -fno-rtti ${CXXFLAGS:-})
+
+# Compiles edd_verify_hpp.cpp to edd_verify_hpp.o for the modes that link edd_verify.c
+compile_verify_hpp() {
+     "${CXX:-c++}" "$@" -c -o edd_verify_hpp.o edd_verify_hpp.cpp
+}
+
+case "$mode" in
+     single)
+          load_emsdk
+          # Compile the c file and build a wasm module bundled with Javascript and loading helpers.
+          emcc "${wasm_flags[@]}" -s SINGLE_FILE=1 -o edd.js edd.c
+          ;;
+     lib)
+          # Fat LTO objects also carry machine code, so consumers that do not use -flto can link
+          # the static library too.
+          "$cc" "${native_flags[@]}" -fPIC -ffat-lto-objects -c -o edd.o edd.c
+          "$cc" "${native_flags[@]}" -fPIC -ffat-lto-objects -c -o edd_arrow.o edd_arrow.c
+          "${AR:-gcc-ar}" rcs libedd.a edd.o edd_arrow.o
+          "$cc" "${native_flags[@]}" -fPIC -shared -pthread -o libedd.so edd.o edd_arrow.o
+          rm -f edd.o edd_arrow.o
+          ;;
+     cli)
+          "$cc" "${native_flags[@]}" -pthread -o edd edd_cli.c edd_server.c edd.c
+          ;;
+     test)
+          compile_verify_hpp "${native_cxx_flags[@]}"
+          "$cc" "${native_flags[@]}" -pthread -o edd_verify edd_verify.c edd.c edd_arrow.c \
+               edd_verify_hpp.o
+          rm -f edd_verify_hpp.o
+          ;;
+     bench)
+          "$cc" "${native_flags[@]}" -pthread -o edd edd_cli.c edd_server.c edd.c
+          "$cc" "${native_flags[@]}" -pthread -o bench bench.c edd.c
+          ;;
+     fuzz)
+          CXX="${CXX:-clang++}" compile_verify_hpp -std=c++17 -O1 -g -fno-exceptions -fno-rtti \
+               -fsanitize=address,undefined ${CXXFLAGS:-}
+          "${CC:-clang}" -std=c2x -O1 -g -fsanitize=fuzzer,address,undefined -DNAEGELES_FUZZ \
+               ${CFLAGS:-} -pthread -o edd_fuzz edd_verify.c edd.c edd_arrow.c \
+               edd_verify_hpp.o
+          rm -f edd_verify_hpp.o
+          ;;
+     *)
+          echo "usage: $0 [single|lib|cli|test|bench|fuzz]" >&2
+          exit 2
+          ;;
+esac
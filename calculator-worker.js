@@ -0,0 +1,38 @@
+/**
+ * Web Worker host for the Naegele's rule WASM module.
+ * Loads edd.js and calculator.js inside the worker and answers requests posted by
+ * NaegelesWorkerCalculator (see calculator.js), so WASM calls never block the UI thread.
+ *
+ * Protocol: the page posts {id, method, args}; the worker replies {id, result} or {id, error}.
+ * Once the module has loaded the worker posts {type: 'ready'}, or {type: 'init-error', error}.
+ */
+
+importScripts('edd.js', 'calculator.js');
+
+// Methods the page may call, all forwarded to the same NaegelesCalculator instance
+const WORKER_METHODS = ['computeEDD', 'computeWOA', 'computeBoth', 'getErrorMessage'];
+
+let calculator = null;
+
+createNaegelesModule().then(Module => {
+    calculator = new NaegelesCalculator(Module);
+    self.postMessage({ type: 'ready' });
+}).catch(error => {
+    self.postMessage({ type: 'init-error', error: String(error && error.message || error) });
+});
+
+self.onmessage = event => {
+    const { id, method, args } = event.data;
+
+    if (!calculator || !WORKER_METHODS.includes(method)) {
+        self.postMessage({ id, error: `Unsupported call: ${method}` });
+        return;
+    }
+
+    try {
+        const result = calculator[method](...args);
+        self.postMessage({ id, result });
+    } catch (error) {
+        self.postMessage({ id, error: String(error && error.message || error) });
+    }
+};
@@ -11,21 +11,36 @@ const NaegelesError = {
     DATE_CONVERSION: -3,
     SYSTEM_TIME: -4,
     FUTURE_DATE: -5,
-    BUFFER_TOO_SMALL: -6
+    BUFFER_TOO_SMALL: -6,
+    NO_MEMORY: -7,
+    UNSUPPORTED: -8
 };
 
 // Buffer sizes matching C constants
 const DATE_STR_MAX_LEN = 16;
 const WOA_STR_MAX_LEN = 32;
 
+// Milliseconds per day, for converting between day numbers and JS dates
+const MS_PER_DAY = 86400000;
+
 /**
  * Naegele's rule calculator wrapper class.
- * Wraps the WASM module functions with memory management.
+ * Wraps the WASM module functions with memory management. Output buffers come from the WASM
+ * stack and are released before each method returns.
+ *
+ * With options.cacheSize > 0, computeEDD, computeWOA and computeBoth keep bounded LRU caches keyed
+ * on the LNMP string, so a repeated lookup skips WASM entirely. EDD results never change and are
+ * kept until evicted; WOA results depend on today's date and are dropped when the day changes.
  */
 class NaegelesCalculator {
-    constructor(wasmModule) {
+    constructor(wasmModule, options = {}) {
         this.Module = wasmModule;
 
+        this._cacheSize = options.cacheSize || 0;
+        this._eddCache = new Map();
+        this._dayCache = new Map();
+        this._cacheDay = null;
+
         // Wrap C functions using cwrap
         this._computeEDD = this.Module.cwrap(
             'naegeles_compute_edd',
@@ -52,25 +67,94 @@ class NaegelesCalculator {
         );
     }
 
+    /**
+     * Converts a civil date to a day number (days since 1970-01-01), as used to key WOA caches.
+     * @param {number} day - Day of month.
+     * @param {number} month - Month (1-12).
+     * @param {number} year - Year.
+     * @returns {number} Day number.
+     */
+    static toDayNumber(day, month, year) {
+        const date = new Date(0);
+        date.setUTCFullYear(year, month - 1, day);
+        return Math.floor(date.getTime() / MS_PER_DAY);
+    }
+
+    /**
+     * Looks up a cached result, marking it most recently used.
+     * @param {Map} cache - _eddCache or _dayCache.
+     * @param {string} key - Cache key.
+     * @returns {Object|undefined} Cached result.
+     */
+    _cacheGet(cache, key) {
+        const value = cache.get(key);
+        if (value !== undefined) {
+            cache.delete(key);
+            cache.set(key, value);
+        }
+        return value;
+    }
+
+    /**
+     * Stores a result, evicting the least recently used entry when the cache is full.
+     * Results are frozen because the same object is handed to every later caller.
+     * @param {Map} cache - _eddCache or _dayCache.
+     * @param {string} key - Cache key.
+     * @param {Object} value - Result to store.
+     * @returns {Object} The stored result.
+     */
+    _cachePut(cache, key, value) {
+        if (this._cacheSize > 0) {
+            if (cache.size >= this._cacheSize) {
+                cache.delete(cache.keys().next().value);
+            }
+            cache.set(key, Object.freeze(value));
+        }
+        return value;
+    }
+
+    /**
+     * Returns the cache of date-dependent results, emptying it first if the local day has
+     * changed since it was filled.
+     * @returns {Map} The WOA cache.
+     */
+    _currentDayCache() {
+        const now = new Date();
+        const today = NaegelesCalculator.toDayNumber(now.getDate(), now.getMonth() + 1, now.getFullYear());
+        if (today !== this._cacheDay) {
+            this._dayCache.clear();
+            this._cacheDay = today;
+        }
+        return this._dayCache;
+    }
+
     /**
      * Computes the Estimated Due Date (EDD) using Naegele's rule.
      * @param {string} lnmp - Last Normal Menstrual Period in dd/mm/yyyy format.
      * @returns {{success: boolean, edd: string|null, error: string|null}}
      */
     computeEDD(lnmp) {
-        // Allocate buffer for EDD output using stackAlloc for automatic cleanup
+        const cached = this._cacheSize > 0 ? this._cacheGet(this._eddCache, lnmp) : undefined;
+        if (cached !== undefined) {
+            return cached;
+        }
+
+        // Allocate the output buffer on the stack; it is released once read
+        const stackStart = this.Module.stackSave();
         const eddBuffer = this.Module.stackAlloc(DATE_STR_MAX_LEN);
 
         // Call the C function
         const result = this._computeEDD(lnmp, eddBuffer, DATE_STR_MAX_LEN);
 
+        // Read the string from the buffer
+        const edd = result === NaegelesError.OK ? this.Module.UTF8ToString(eddBuffer) : null;
+        this.Module.stackRestore(stackStart);
+
         if (result === NaegelesError.OK) {
-            // Read the string from the buffer
-            const edd = this.Module.UTF8ToString(eddBuffer);
-            return { success: true, edd, error: null };
+            return this._cachePut(this._eddCache, lnmp, { success: true, edd, error: null });
         } else {
             const error = this._errorString(result);
-            return { success: false, edd: null, error };
+            return this._cachePut(this._eddCache, lnmp, { success: false, edd: null, error });
         }
     }
 
@@ -80,19 +164,28 @@ class NaegelesCalculator {
      * @returns {{success: boolean, woa: string|null, error: string|null}}
      */
     computeWOA(lnmp) {
-        // Allocate buffer for WOA output using stackAlloc for automatic cleanup
+        const cache = this._cacheSize > 0 ? this._currentDayCache() : null;
+        const cached = cache ? this._cacheGet(cache, 'w' + lnmp) : undefined;
+        if (cached !== undefined) {
+            return cached;
+        }
+
+        // Allocate the output buffer on the stack; it is released once read
+        const stackStart = this.Module.stackSave();
         const woaBuffer = this.Module.stackAlloc(WOA_STR_MAX_LEN);
 
         // Call the C function
         const result = this._computeWOA(lnmp, woaBuffer, WOA_STR_MAX_LEN);
 
+        // Read the string from the buffer
+        const woa = result === NaegelesError.OK ? this.Module.UTF8ToString(woaBuffer) : null;
+        this.Module.stackRestore(stackStart);
+
         if (result === NaegelesError.OK) {
-            // Read the string from the buffer
-            const woa = this.Module.UTF8ToString(woaBuffer);
-            return { success: true, woa, error: null };
+            return this._cachePut(cache, 'w' + lnmp, { success: true, woa, error: null });
         } else {
             const error = this._errorString(result);
-            return { success: false, woa: null, error };
+            return this._cachePut(cache, 'w' + lnmp, { success: false, woa: null, error });
         }
     }
 
@@ -102,9 +195,14 @@ class NaegelesCalculator {
      * @returns {{success: boolean, edd: string|null, woa: string|null, error: string|null}}
      */
     computeBoth(lnmp) {
-        // Allocate buffers for both outputs using stackAlloc for automatic cleanup
-        const stackStart = this.Module.stackSave();
+        const cache = this._cacheSize > 0 ? this._currentDayCache() : null;
+        const cached = cache ? this._cacheGet(cache, 'b' + lnmp) : undefined;
+        if (cached !== undefined) {
+            return cached;
+        }
 
+        // Allocate buffers for both outputs on the stack; they are released once read
+        const stackStart = this.Module.stackSave();
         const eddBuffer = this.Module.stackAlloc(DATE_STR_MAX_LEN);
         const woaBuffer = this.Module.stackAlloc(WOA_STR_MAX_LEN);
 
@@ -115,17 +213,16 @@ class NaegelesCalculator {
             woaBuffer, WOA_STR_MAX_LEN
         );
 
-        if (result === NaegelesError.OK) {
-            // Read both strings from their buffers
-            const edd = this.Module.UTF8ToString(eddBuffer);
-            const woa = this.Module.UTF8ToString(woaBuffer);
+        // Read both strings from their buffers
+        const edd = result === NaegelesError.OK ? this.Module.UTF8ToString(eddBuffer) : null;
+        const woa = result === NaegelesError.OK ? this.Module.UTF8ToString(woaBuffer) : null;
+        this.Module.stackRestore(stackStart);
 
-            this.Module.stackRestore(stackStart);
-            return { success: true, edd, woa, error: null };
+        if (result === NaegelesError.OK) {
+            return this._cachePut(cache, 'b' + lnmp, { success: true, edd, woa, error: null });
         } else {
             const error = this._errorString(result);
-            this.Module.stackRestore(stackStart);
-            return { success: false, edd: null, woa: null, error };
+            return this._cachePut(cache, 'b' + lnmp, { success: false, edd: null, woa: null, error });
         }
     }
 
@@ -139,7 +236,123 @@ class NaegelesCalculator {
     }
 }
 
-function initNaegelesCalculator() {
+/**
+ * Proxy for a NaegelesCalculator hosted in a Web Worker (see calculator-worker.js).
+ * Offers the same methods, but each returns a promise, so the WASM calls never run on the UI
+ * thread.
+ */
+class NaegelesWorkerCalculator {
+    constructor(worker) {
+        this._worker = worker;
+        this._nextId = 1;
+        this._pending = new Map();
+
+        this._worker.onmessage = event => {
+            const { id, result, error } = event.data;
+            const pending = this._pending.get(id);
+            if (!pending) {
+                return;
+            }
+
+            this._pending.delete(id);
+            if (error !== undefined) {
+                pending.reject(new Error(error));
+            } else {
+                pending.resolve(result);
+            }
+        };
+    }
+
+    /**
+     * Posts a call to the worker.
+     * @param {string} method - NaegelesCalculator method name.
+     * @param {Array} args - Method arguments.
+     * @returns {Promise<*>} The method's return value.
+     */
+    _call(method, args) {
+        return new Promise((resolve, reject) => {
+            const id = this._nextId++;
+            this._pending.set(id, { resolve, reject });
+            this._worker.postMessage({ id, method, args });
+        });
+    }
+
+    /** @see NaegelesCalculator#computeEDD */
+    computeEDD(lnmp) {
+        return this._call('computeEDD', [lnmp]);
+    }
+
+    /** @see NaegelesCalculator#computeWOA */
+    computeWOA(lnmp) {
+        return this._call('computeWOA', [lnmp]);
+    }
+
+    /** @see NaegelesCalculator#computeBoth */
+    computeBoth(lnmp) {
+        return this._call('computeBoth', [lnmp]);
+    }
+
+    /** @see NaegelesCalculator#getErrorMessage */
+    getErrorMessage(errorCode) {
+        return this._call('getErrorMessage', [errorCode]);
+    }
+
+    /**
+     * Terminates the worker and rejects any calls still in flight.
+     */
+    destroy() {
+        this._worker.terminate();
+        for (const pending of this._pending.values()) {
+            pending.reject(new Error('Calculator worker terminated'));
+        }
+        this._pending.clear();
+    }
+}
+
+/**
+ * Starts a calculator hosted in a Web Worker.
+ * @param {string} workerUrl - URL of calculator-worker.js.
+ * @returns {Promise<NaegelesWorkerCalculator>}
+ */
+function initWorkerCalculator(workerUrl) {
+    return new Promise((resolve, reject) => {
+        if (typeof Worker === 'undefined') {
+            reject(new Error('Web Workers are not supported in this environment.'));
+            return;
+        }
+
+        const worker = new Worker(workerUrl);
+
+        worker.onmessage = event => {
+            if (event.data.type === 'ready') {
+                console.log('Naegele\'s rule calculator ready (worker)');
+                resolve(new NaegelesWorkerCalculator(worker));
+            } else if (event.data.type === 'init-error') {
+                worker.terminate();
+                reject(new Error(event.data.error));
+            }
+        };
+
+        worker.onerror = event => {
+            worker.terminate();
+            reject(new Error(event.message || 'Failed to load calculator worker'));
+        };
+    });
+}
+
+/**
+ * Initializes the calculator.
+ * @param {{worker?: boolean, workerUrl?: string, cacheSize?: number}} [options] - worker: host the
+ *     WASM module in a Web Worker and resolve to a NaegelesWorkerCalculator whose methods return
+ *     promises. workerUrl: location of calculator-worker.js (default: './calculator-worker.js').
+ *     cacheSize: entries per result cache of the in-page calculator (default: 0, no caching).
+ * @returns {Promise<NaegelesCalculator|NaegelesWorkerCalculator>}
+ */
+function initNaegelesCalculator(options = {}) {
+    if (options.worker) {
+        return initWorkerCalculator(options.workerUrl || './calculator-worker.js');
+    }
+
     return new Promise((resolve, reject) => {
         if (typeof createNaegelesModule === 'undefined') {
             reject(new Error('WASM module not found. Make sure edd.js is loaded first.'));
@@ -148,7 +361,7 @@ function initNaegelesCalculator() {
 
         createNaegelesModule().then(Module => {
             try {
-                const calculator = new NaegelesCalculator(Module);
+                const calculator = new NaegelesCalculator(Module, options);
                 console.log('Naegele\'s rule calculator ready');
                 resolve(calculator);
             } catch (error) {
@@ -160,12 +373,13 @@ function initNaegelesCalculator() {
 
 // Export for use in other modules (Node.js/bundlers)
 if (typeof module !== 'undefined' && module.exports) {
-    module.exports = { NaegelesCalculator, NaegelesError, initNaegelesCalculator };
+    module.exports = { NaegelesCalculator, NaegelesWorkerCalculator, NaegelesError, initNaegelesCalculator };
 }
 
 // Export for browser global scope
 if (typeof window !== 'undefined') {
     window.NaegelesCalculator = NaegelesCalculator;
+    window.NaegelesWorkerCalculator = NaegelesWorkerCalculator;
     window.NaegelesError = NaegelesError;
     window.initNaegelesCalculator = initNaegelesCalculator;
 }
@@ -1,259 +1,2370 @@
+#define _POSIX_C_SOURCE 200809L  // for localtime_r, strnlen, sysconf
+
+#include "edd.h"
+
 #include <stdbool.h>  // for bool, true, false
-#include <stdio.h>    // for printf, fprintf, sscanf, snprintf
-#include <stdlib.h>   // for exit
-#include <string.h>   // for strlen
-#include <time.h>     // for time_t, struct tm, mktime, difftime, time
+#include <stddef.h>   // for size_t
+#include <stdint.h>   // for int16_t, int32_t, int64_t, uint8_t, uint32_t, uint64_t
+#include <stdlib.h>   // for malloc, calloc, free
+#include <string.h>   // for memcpy, strnlen
+#include <time.h>     // for time_t, struct tm, time, localtime_r
+
+#ifndef WASM_BUILD
+#include <pthread.h>  // for pthread_t, pthread_create, pthread_mutex_t, pthread_cond_t
+#include <unistd.h>   // for sysconf
+#endif
+
+#ifdef NAEGELES_STATS
+#include <stdatomic.h>  // for atomic_load_explicit, atomic_store_explicit
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // for __rdtsc
+#endif
+#endif
+
+/** Days to add to LMP day component for EDD calculation. */
+#define EDD_DAY_OFFSET 7
+
+/** Months to adjust for EDD (subtract 3 or add 9). */
+#define EDD_MONTH_OFFSET 3
+
+/** Earliest year accepted by is_valid_date. */
+#define MIN_YEAR 1900
+
+/** Latest year accepted by is_valid_date. */
+#define MAX_YEAR 2100
+
+/** Last year covered by the calendar tables; the EDD of a late-2100 LNMP falls in 2101. */
+#define TABLE_MAX_YEAR (MAX_YEAR + 1)
+
+/** Compile-time leap year test used to build the calendar tables. */
+#define LEAP_YEAR(y) (((y) % 4 == 0 && (y) % 100 != 0) || (y) % 400 == 0)
+
+/** Compile-time day number of 1 January of year y (y >= 1), used to build the tables. */
+#define YEAR_START(y) \
+    (365 * ((y) - 1970) + ((y) - 1) / 4 - ((y) - 1) / 100 + ((y) - 1) / 400 - 477)
+
+/** Expands F for ten consecutive years starting at y. */
+#define REPEAT_YEARS_10(F, y)                                                                \
+    F(y) F((y) + 1) F((y) + 2) F((y) + 3) F((y) + 4) F((y) + 5) F((y) + 6) F((y) + 7)        \
+    F((y) + 8) F((y) + 9)
+
+/** Expands F for a hundred consecutive years starting at y. */
+#define REPEAT_YEARS_100(F, y)                                                               \
+    REPEAT_YEARS_10(F, y) REPEAT_YEARS_10(F, (y) + 10) REPEAT_YEARS_10(F, (y) + 20)          \
+    REPEAT_YEARS_10(F, (y) + 30) REPEAT_YEARS_10(F, (y) + 40) REPEAT_YEARS_10(F, (y) + 50)   \
+    REPEAT_YEARS_10(F, (y) + 60) REPEAT_YEARS_10(F, (y) + 70) REPEAT_YEARS_10(F, (y) + 80)   \
+    REPEAT_YEARS_10(F, (y) + 90)
+
+/** Expands F for every year from MIN_YEAR (1900) to TABLE_MAX_YEAR (2101). */
+#define REPEAT_TABLE_YEARS(F) REPEAT_YEARS_100(F, 1900) REPEAT_YEARS_100(F, 2000) F(2100) F(2101)
+
+#define YEAR_START_ENTRY(y) YEAR_START(y),
+#define LEAP_YEAR_ENTRY(y)  LEAP_YEAR(y),
+
+/** Day number of 1 January for each year from MIN_YEAR to TABLE_MAX_YEAR. */
+static const int32_t year_start_days[TABLE_MAX_YEAR - MIN_YEAR + 1] = {
+    REPEAT_TABLE_YEARS(YEAR_START_ENTRY)};
+
+/** Leap year flag (0 or 1) for each year from MIN_YEAR to TABLE_MAX_YEAR. */
+static const uint8_t year_is_leap[TABLE_MAX_YEAR - MIN_YEAR + 1] = {
+    REPEAT_TABLE_YEARS(LEAP_YEAR_ENTRY)};
+
+/** Days before the first of each month (index 1-12), by leap flag. */
+static const int16_t days_before_month[2][13] = {
+    {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334},
+    {0, 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335},
+};
+
+/** Length of each month (index 1-12), by leap flag. */
+static const uint8_t month_length[2][13] = {
+    {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
+    {0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
+};
+
+/** Day number of 1900-01-01, the earliest valid LNMP. */
+#define MIN_DAY_NUMBER YEAR_START(MIN_YEAR)
+
+/** Day number of 2100-12-31, the latest valid LNMP. */
+#define MAX_DAY_NUMBER (YEAR_START(MAX_YEAR + 1) - 1)
+
+_Static_assert(MIN_DAY_NUMBER == -25567, "1900-01-01 must be day -25567");
+_Static_assert(MAX_DAY_NUMBER == 47846, "2100-12-31 must be day 47846");
+
+/**
+ * Returns the number of days in a given month for a given year.
+ * @param month Month (1-12).
+ * @param year Year to account for leap years (MIN_YEAR to TABLE_MAX_YEAR).
+ * @return Number of days in the month, or 0 if month is invalid.
+ */
+static int days_in_month(int month, int year) {
+    if (month < 1 || month > 12) {
+        return 0;
+    }
+    return month_length[year_is_leap[year - MIN_YEAR]][month];
+}
+
+/**
+ * Validates if a date is valid.
+ * @param day Day of month (1-31).
+ * @param month Month (1-12).
+ * @param year Year (must be reasonable, e.g., 1900-2100).
+ * @return true if valid, false otherwise.
+ */
+static bool is_valid_date(int day, int month, int year) {
+    if (year < MIN_YEAR || year > MAX_YEAR) {
+        return false;
+    }
+    if (month < 1 || month > 12) {
+        return false;
+    }
+    if (day < 1 || day > days_in_month(month, year)) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Converts a civil date to a day number (days since 1970-01-01) by table lookup.
+ * The day component may exceed the month length; the excess rolls over into the following month.
+ * @param day Day of month.
+ * @param month Month (1-12).
+ * @param year Year (MIN_YEAR to TABLE_MAX_YEAR).
+ * @return Day number.
+ */
+static inline int32_t days_from_civil(int day, int month, int year) {
+    const int index = year - MIN_YEAR;
+    return year_start_days[index] + days_before_month[year_is_leap[index]][month] + day - 1;
+}
+
+/**
+ * Converts any proleptic Gregorian date to a day number (days since 1970-01-01).
+ * Used only for the system date, which is not guaranteed to fall inside the table range.
+ * @param day Day of month.
+ * @param month Month (1-12).
+ * @param year Year.
+ * @return Day number.
+ */
+static int32_t days_from_civil_any(int day, int month, int year) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;                                // [0, 399]
+    const int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;           // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * Converts a day number (days since 1970-01-01) to a civil date.
+ * @param days Day number.
+ * @param day Output day of month.
+ * @param month Output month (1-12).
+ * @param year Output year.
+ */
+static void civil_from_days(int32_t days, int* day, int* month, int* year) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const int doe = days - era * 146097;                             // [0, 146096]
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);         // [0, 365]
+    const int mp  = (5 * doy + 2) / 153;                             // [0, 11], March-based
+    *day          = doy - (153 * mp + 2) / 5 + 1;
+    *month        = mp < 10 ? mp + 3 : mp - 9;
+    *year         = yoe + era * 400 + (*month <= 2);
+}
+
+/**
+ * Returns today's local date as a day number.
+ * @param today Output day number.
+ * @return true on success, false if the system time is unavailable.
+ */
+static bool current_day_number(int32_t* today) {
+    time_t now = time(NULL);
+    if (now == (time_t)-1) {
+        return false;
+    }
+
+    struct tm now_tm;
+    if (localtime_r(&now, &now_tm) == NULL) {
+        return false;
+    }
+
+    *today = days_from_civil_any(now_tm.tm_mday, now_tm.tm_mon + 1, now_tm.tm_year + 1900);
+    return true;
+}
+
+/**
+ * Applies Naegele's rule to an LNMP day number.
+ * Naegele's rule: Add 7 days, subtract 3 months (or add 9), add 1 year if needed.
+ * When the shifted month is shorter than the day (e.g. 31/09), the EDD rolls over into the
+ * following month.
+ * @param lnmp_days LNMP as a day number.
+ * @return EDD as a day number.
+ */
+static int32_t naegele_rule(int32_t lnmp_days) {
+    int day = 0, month = 0, year = 0;
+
+    // +7 days, carried across month and year boundaries by the day number
+    civil_from_days(lnmp_days + EDD_DAY_OFFSET, &day, &month, &year);
+
+    // -3 months, +1 year (or +9 months if month <= 3)
+    if (month > EDD_MONTH_OFFSET) {
+        month -= EDD_MONTH_OFFSET;
+        year += 1;
+    } else {
+        month += (12 - EDD_MONTH_OFFSET);
+    }
+
+    return days_from_civil(day, month, year);
+}
+
+#ifdef NAEGELES_EDD_LUT
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "NAEGELES_EDD_LUT needs GCC or Clang for the table constructor"
+#endif
+
+/**
+ * Smallest EDD - LNMP distance in days over the valid range; every distance is 280 to 283, so
+ * the table stores it as a byte above this base (72 KB instead of 287 KB of int32 EDDs).
+ */
+#define EDD_LUT_BASE 280
+
+/** EDD - LNMP - EDD_LUT_BASE for every valid LNMP, indexed by lnmp - MIN_DAY_NUMBER. */
+static uint8_t edd_lut[MAX_DAY_NUMBER - MIN_DAY_NUMBER + 1];
+
+/** Fills edd_lut before main (or before the WASM module's first export call) runs. */
+__attribute__((constructor)) static void edd_lut_init(void) {
+    for (int32_t days = MIN_DAY_NUMBER; days <= MAX_DAY_NUMBER; days++) {
+        edd_lut[days - MIN_DAY_NUMBER] = (uint8_t)(naegele_rule(days) - days - EDD_LUT_BASE);
+    }
+}
+#endif  // NAEGELES_EDD_LUT
+
+/**
+ * Returns the EDD day number for a valid LNMP day number (MIN_DAY_NUMBER to MAX_DAY_NUMBER).
+ * Built with -DNAEGELES_EDD_LUT this is one table load instead of a civil date round trip.
+ * @param lnmp_days LNMP as a day number.
+ * @return EDD as a day number.
+ */
+static inline int32_t edd_from_lnmp(int32_t lnmp_days) {
+#ifdef NAEGELES_EDD_LUT
+    return lnmp_days + EDD_LUT_BASE + edd_lut[lnmp_days - MIN_DAY_NUMBER];
+#else
+    return naegele_rule(lnmp_days);
+#endif
+}
+
+/** Low nibble of every byte lane: the digit value of an ASCII digit. */
+#define LANE_LOW_NIBBLES 0x0F0F0F0F0F0F0F0Full
+
+/** Added to the low nibbles to detect ':' through '?' (they carry into the high nibble). */
+#define LANE_CARRY_SIX 0x0606060606060606ull
+
+/** High nibbles of the "dd/mm/yy" digit lanes, in little-endian load order. */
+#define DATE_DIGIT_HIGH 0xF0F000F0F000F0F0ull
+
+/** Bits of "dd/mm/yy" with a fixed expected value: digit high nibbles and whole separators. */
+#define DATE_FIXED_BITS 0xF0F0FFF0F0FFF0F0ull
+
+/** Expected value of DATE_FIXED_BITS: 0x3_ for digits, '/' (0x2F) for separators. */
+#define DATE_FIXED_PATTERN 0x30302F30302F3030ull
+
+/** Expected value of DATE_FIXED_BITS for "dd-mm-yy": '-' (0x2D) separators. */
+#define DATE_DASH_PATTERN 0x30302D30302D3030ull
+
+/** High nibbles of the "yyyy-mm-" digit lanes. */
+#define ISO_DIGIT_HIGH 0x00F0F000F0F0F0F0ull
+
+/** Bits of "yyyy-mm-" with a fixed expected value. */
+#define ISO_FIXED_BITS 0xFFF0F0FFF0F0F0F0ull
+
+/** Expected value of ISO_FIXED_BITS. */
+#define ISO_FIXED_PATTERN 0x2D30302D30303030ull
+
+/** High nibbles of "yyyymmdd", all digit lanes. */
+#define COMPACT_DIGIT_HIGH 0xF0F0F0F0F0F0F0F0ull
+
+/** Expected value of COMPACT_DIGIT_HIGH: every lane an ASCII digit. */
+#define COMPACT_FIXED_PATTERN 0x3030303030303030ull
+
+/** Record length of the yyyymmdd layout. */
+#define COMPACT_STR_LEN 8
+
+/** Digit value of byte lane i of a masked word. */
+#define LANE(low, i) ((unsigned)((low) >> (8 * (i)) & 0xFF))
+
+/**
+ * Loads 8 bytes as a little-endian word regardless of host byte order or alignment.
+ * Compilers fold this into a single load on little-endian targets.
+ * @param p Pointer to at least 8 readable bytes.
+ * @return The loaded word.
+ */
+static inline uint64_t load_le64(const char* p) {
+    const unsigned char* b = (const unsigned char*)p;
+    return (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16 | (uint64_t)b[3] << 24 |
+           (uint64_t)b[4] << 32 | (uint64_t)b[5] << 40 | (uint64_t)b[6] << 48 |
+           (uint64_t)b[7] << 56;
+}
+
+/**
+ * Checks 8 bytes against a layout in one word (SWAR): the bits in fixed_bits must equal
+ * pattern (digit high nibbles and whole separators), and the low nibble + 6 of every digit
+ * lane must not carry into its high nibble (rejects ':' through '?').
+ * @param word Little-endian word of the 8 bytes.
+ * @param fixed_bits Bits with a fixed expected value.
+ * @param pattern Expected value of fixed_bits.
+ * @param digit_high High nibbles of the digit lanes.
+ * @return true if every lane matches.
+ */
+static inline bool layout_matches(uint64_t word, uint64_t fixed_bits, uint64_t pattern,
+                                  uint64_t digit_high) {
+    const uint64_t low = word & LANE_LOW_NIBBLES;
+    return (word & fixed_bits) == pattern && ((low + LANE_CARRY_SIX) & digit_high) == 0;
+}
+
+/**
+ * Parses exactly DATE_STR_LEN bytes in dd?mm?yyyy layout without looking for a terminator.
+ * The first 8 bytes are checked as one word (layout_matches), so signs, spaces and other
+ * sscanf leniencies are rejected.
+ * @param p Pointer to at least DATE_STR_LEN readable bytes.
+ * @param pattern DATE_FIXED_PATTERN for '/' separators, DATE_DASH_PATTERN for '-'.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static inline bool parse_dmy_fixed(const char* p, uint64_t pattern, int* day, int* month,
+                                   int* year) {
+    const uint64_t word = load_le64(p);
+    const uint64_t low  = word & LANE_LOW_NIBBLES;
+    const unsigned y2   = (unsigned char)p[8] - '0';
+    const unsigned y3   = (unsigned char)p[9] - '0';
+
+    if (!layout_matches(word, DATE_FIXED_BITS, pattern, DATE_DIGIT_HIGH) || y2 > 9 || y3 > 9) {
+        return false;
+    }
+
+    *day   = (int)(LANE(low, 0) * 10 + LANE(low, 1));
+    *month = (int)(LANE(low, 3) * 10 + LANE(low, 4));
+    *year  = (int)(LANE(low, 6) * 1000 + LANE(low, 7) * 100 + y2 * 10 + y3);
+
+    // Validate the parsed date
+    return is_valid_date(*day, *month, *year);
+}
+
+/**
+ * Parses exactly DATE_STR_LEN bytes in dd/mm/yyyy layout; see parse_dmy_fixed.
+ * @param p Pointer to at least DATE_STR_LEN readable bytes.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static inline bool parse_date_fixed(const char* p, int* day, int* month, int* year) {
+    return parse_dmy_fixed(p, DATE_FIXED_PATTERN, day, month, year);
+}
+
+/**
+ * Parses exactly DATE_STR_LEN bytes in yyyy-mm-dd layout without looking for a terminator.
+ * @param p Pointer to at least DATE_STR_LEN readable bytes.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static inline bool parse_iso_fixed(const char* p, int* day, int* month, int* year) {
+    const uint64_t word = load_le64(p);
+    const uint64_t low  = word & LANE_LOW_NIBBLES;
+    const unsigned d0   = (unsigned char)p[8] - '0';
+    const unsigned d1   = (unsigned char)p[9] - '0';
+
+    if (!layout_matches(word, ISO_FIXED_BITS, ISO_FIXED_PATTERN, ISO_DIGIT_HIGH) || d0 > 9 ||
+        d1 > 9) {
+        return false;
+    }
+
+    *year  = (int)(LANE(low, 0) * 1000 + LANE(low, 1) * 100 + LANE(low, 2) * 10 + LANE(low, 3));
+    *month = (int)(LANE(low, 5) * 10 + LANE(low, 6));
+    *day   = (int)(d0 * 10 + d1);
+    return is_valid_date(*day, *month, *year);
+}
+
+/**
+ * Parses exactly COMPACT_STR_LEN bytes in yyyymmdd layout without looking for a terminator.
+ * @param p Pointer to at least COMPACT_STR_LEN readable bytes.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static inline bool parse_compact_fixed(const char* p, int* day, int* month, int* year) {
+    const uint64_t word = load_le64(p);
+    const uint64_t low  = word & LANE_LOW_NIBBLES;
+
+    if (!layout_matches(word, COMPACT_DIGIT_HIGH, COMPACT_FIXED_PATTERN, COMPACT_DIGIT_HIGH)) {
+        return false;
+    }
+
+    *year  = (int)(LANE(low, 0) * 1000 + LANE(low, 1) * 100 + LANE(low, 2) * 10 + LANE(low, 3));
+    *month = (int)(LANE(low, 4) * 10 + LANE(low, 5));
+    *day   = (int)(LANE(low, 6) * 10 + LANE(low, 7));
+    return is_valid_date(*day, *month, *year);
+}
+
+/**
+ * Parses one fixed-width record in a layout. Called with a constant layout the switch folds
+ * away, leaving the dedicated parser inline.
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ * @param p Pointer to at least layout_length(layout) readable bytes.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static inline bool parse_layout_fixed(naegeles_date_layout_t layout, const char* p, int* day,
+                                      int* month, int* year) {
+    switch (layout) {
+        case NAEGELES_LAYOUT_DMY_DASH:
+            return parse_dmy_fixed(p, DATE_DASH_PATTERN, day, month, year);
+        case NAEGELES_LAYOUT_ISO:
+            return parse_iso_fixed(p, day, month, year);
+        case NAEGELES_LAYOUT_COMPACT:
+            return parse_compact_fixed(p, day, month, year);
+        default:
+            return parse_date_fixed(p, day, month, year);
+    }
+}
+
+/**
+ * Returns the record length of a layout.
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ * @return Length in bytes.
+ */
+static inline size_t layout_length(naegeles_date_layout_t layout) {
+    return layout == NAEGELES_LAYOUT_COMPACT ? COMPACT_STR_LEN : DATE_STR_LEN;
+}
+
+/**
+ * Recognizes a record's layout from its separators, or from eight leading digits.
+ * @param p Record bytes.
+ * @param len Readable bytes at p.
+ * @return The layout, or NAEGELES_LAYOUT_AUTO if none fits.
+ */
+static naegeles_date_layout_t detect_layout(const char* p, size_t len) {
+    if (len >= DATE_STR_LEN) {
+        if (p[2] == '/' && p[5] == '/') {
+            return NAEGELES_LAYOUT_DMY_SLASH;
+        }
+        if (p[2] == '-' && p[5] == '-') {
+            return NAEGELES_LAYOUT_DMY_DASH;
+        }
+        if (p[4] == '-' && p[7] == '-') {
+            return NAEGELES_LAYOUT_ISO;
+        }
+    }
+    if (len >= COMPACT_STR_LEN) {
+        const uint64_t word = load_le64(p);
+        if (layout_matches(word, COMPACT_DIGIT_HIGH, COMPACT_FIXED_PATTERN, COMPACT_DIGIT_HIGH)) {
+            return NAEGELES_LAYOUT_COMPACT;
+        }
+    }
+    return NAEGELES_LAYOUT_AUTO;
+}
+
+/**
+ * Parses a date string in dd/mm/yyyy format.
+ * @param lnmp Input date string.
+ * @param day Output day.
+ * @param month Output month.
+ * @param year Output year.
+ * @return true on successful parse and validation, false otherwise.
+ */
+static bool parse_date(const char* lnmp, int* day, int* month, int* year) {
+    if (lnmp == NULL || day == NULL || month == NULL || year == NULL) {
+        return false;
+    }
+
+    // Expected format: dd/mm/yyyy (exactly 10 characters). strnlen never reads past the
+    // terminator of a shorter string, and stops early on a longer one.
+    if (strnlen(lnmp, DATE_STR_LEN + 1) != DATE_STR_LEN) {
+        return false;
+    }
+
+    return parse_date_fixed(lnmp, day, month, year);
+}
+
+#ifdef NAEGELES_STATS
+/** Offsets of the counters in a stats block, in naegeles_stats_t field order. */
+enum {
+    STAT_CALLS,
+    STAT_BATCH_CALLS,
+    STAT_BATCH_ROWS,
+    STAT_PARSE_ROWS,
+    STAT_STAGE_TICKS,
+    STAT_ERRORS  = STAT_STAGE_TICKS + NAEGELES_STAGE_COUNT,
+    STAT_LATENCY = STAT_ERRORS + NAEGELES_ERROR_CODES,
+    STAT_COUNT   = STAT_LATENCY + NAEGELES_LATENCY_BUCKETS
+};
+
+/**
+ * One thread's counters. Only the owning thread writes them, with relaxed load/store pairs
+ * that compile to plain adds; naegeles_stats_snapshot reads them from any thread.
+ */
+typedef struct stats_block {
+    _Atomic uint64_t counters[STAT_COUNT];
+    struct stats_block* next; /**< Next live block, guarded by stats_lock. */
+} stats_block_t;
+
+/** Nesting depth of string entry points on this thread, so only the outermost call counts. */
+static _Thread_local int stats_depth;
+
+#ifdef WASM_BUILD
+/** Counters of the single WASM thread. */
+static stats_block_t stats_main;
+
+/**
+ * Returns the calling thread's stats block.
+ * @return Stats block.
+ */
+static inline stats_block_t* stats_block(void) {
+    return &stats_main;
+}
+#else
+/** Live per-thread blocks, merged on read. */
+static stats_block_t* stats_threads;
+
+/** Totals folded in from threads that have exited. */
+static uint64_t stats_retired[STAT_COUNT];
+
+/** Guards stats_threads and stats_retired. */
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Thread-specific key whose destructor retires a thread's block. */
+static pthread_key_t stats_key;
+static pthread_once_t stats_key_once = PTHREAD_ONCE_INIT;
+
+/** The calling thread's block, created on first use. */
+static _Thread_local stats_block_t* stats_tls;
+
+/**
+ * Thread exit hook: folds a block into stats_retired and frees it.
+ * @param arg The exiting thread's stats_block_t.
+ */
+static void stats_retire(void* arg) {
+    stats_block_t* block = arg;
+
+    pthread_mutex_lock(&stats_lock);
+    for (stats_block_t** link = &stats_threads; *link != NULL; link = &(*link)->next) {
+        if (*link == block) {
+            *link = block->next;
+            break;
+        }
+    }
+    for (int i = 0; i < STAT_COUNT; i++) {
+        stats_retired[i] += atomic_load_explicit(&block->counters[i], memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    free(block);
+}
+
+/** Creates stats_key once per process. */
+static void stats_key_create(void) {
+    pthread_key_create(&stats_key, stats_retire);
+}
+
+/**
+ * Returns the calling thread's stats block, registering a new one on first use.
+ * @return Stats block, or NULL if it could not be allocated (the update is then dropped).
+ */
+static inline stats_block_t* stats_block(void) {
+    if (stats_tls != NULL) {
+        return stats_tls;
+    }
+
+    stats_block_t* block = calloc(1, sizeof(*block));
+    if (block == NULL) {
+        return NULL;
+    }
+
+    pthread_once(&stats_key_once, stats_key_create);
+    pthread_setspecific(stats_key, block);
+
+    pthread_mutex_lock(&stats_lock);
+    block->next   = stats_threads;
+    stats_threads = block;
+    pthread_mutex_unlock(&stats_lock);
+
+    stats_tls = block;
+    return block;
+}
+#endif
+
+/**
+ * Adds to one of the calling thread's counters.
+ * @param counter STAT_* offset.
+ * @param value Amount to add.
+ */
+static inline void stats_add(int counter, uint64_t value) {
+    stats_block_t* block = stats_block();
+    if (block != NULL) {
+        _Atomic uint64_t* c = &block->counters[counter];
+        atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + value,
+                              memory_order_relaxed);
+    }
+}
+
+/** 1 when stats_ticks reads the x86 TSC, 0 when it falls back to nanoseconds. */
+#if defined(__x86_64__) || defined(__i386__)
+#define STATS_TICKS_ARE_CYCLES 1
+#else
+#define STATS_TICKS_ARE_CYCLES 0
+#endif
+
+/**
+ * Returns a timestamp for stage and latency measurements.
+ * @return TSC cycles on x86, monotonic nanoseconds elsewhere.
+ */
+static inline uint64_t stats_ticks(void) {
+#if STATS_TICKS_ARE_CYCLES
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * Records a result code: one per string call, or one per batch row.
+ * @param code naegeles_error_t code.
+ */
+static inline void stats_count_error(int code) {
+    if (code <= 0 && code > -NAEGELES_ERROR_CODES) {
+        stats_add(STAT_ERRORS - code, 1);
+    }
+}
+
+/**
+ * Starts timing a string entry point.
+ * @return Start timestamp.
+ */
+static inline uint64_t stats_call_begin(void) {
+    stats_depth++;
+    return stats_ticks();
+}
+
+/**
+ * Finishes timing a string entry point; only the outermost call is recorded.
+ * @param start Timestamp from stats_call_begin.
+ * @param code Result code of the call.
+ * @return code, so the call can be wrapped in a return statement.
+ */
+static inline int stats_call_end(uint64_t start, int code) {
+    uint64_t elapsed = stats_ticks() - start;
+    if (--stats_depth > 0) {
+        return code;
+    }
+
+    int bucket = 0;
+    while (bucket + 1 < NAEGELES_LATENCY_BUCKETS && elapsed >> (bucket + 1) != 0) {
+        bucket++;
+    }
+
+    stats_add(STAT_CALLS, 1);
+    stats_add(STAT_LATENCY + bucket, 1);
+    stats_count_error(code);
+    return code;
+}
+
+/** Declares a timestamp taken now. */
+#define STATS_TICK(name) const uint64_t name = stats_ticks()
+
+/** Adds the time since a STATS_TICK timestamp to a stage. */
+#define STATS_STAGE(stage, since) stats_add(STAT_STAGE_TICKS + (stage), stats_ticks() - (since))
+
+/** Opens a string entry point; pair with STATS_RETURN. */
+#define STATS_CALL_BEGIN() const uint64_t stats_call_start = stats_call_begin()
+
+/** Closes a string entry point and returns its result code. */
+#define STATS_RETURN(code) return stats_call_end(stats_call_start, (code))
+#else
+#define STATS_TICK(name)          ((void)0)
+#define STATS_STAGE(stage, since) ((void)0)
+#define STATS_CALL_BEGIN()        ((void)0)
+#define STATS_RETURN(code)        return (code)
+#endif  // NAEGELES_STATS
+
+/**
+ * Parses an LNMP string and fills the EDD fields of a result.
+ * @param lnmp LNMP in dd/mm/yyyy format.
+ * @param out Result to fill; reset first.
+ * @param lnmp_days Output LNMP day number, set on success.
+ * @return NAEGELES_OK on success, NAEGELES_ERR_INVALID_DATE otherwise.
+ */
+static int compute_edd_result(const char* lnmp, naegeles_result_t* out, int32_t* lnmp_days) {
+    *out = (naegeles_result_t){0};
+
+    int day = 0, month = 0, year = 0;
+    STATS_TICK(parse_start);
+    bool parsed = parse_date(lnmp, &day, &month, &year);
+    STATS_STAGE(NAEGELES_STAGE_PARSE, parse_start);
+    if (!parsed) {
+        out->status = NAEGELES_ERR_INVALID_DATE;
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    STATS_TICK(edd_start);
+    *lnmp_days = days_from_civil(day, month, year);
+    civil_from_days(edd_from_lnmp(*lnmp_days), &out->edd_day, &out->edd_month, &out->edd_year);
+    STATS_STAGE(NAEGELES_STAGE_EDD, edd_start);
+    out->status = NAEGELES_OK;
+    return NAEGELES_OK;
+}
+
+/**
+ * Fills the WOA fields of a result from the LNMP and reference day numbers.
+ * @param out Result whose EDD fields are already set.
+ * @param lnmp_days LNMP day number.
+ * @param as_of Reference date day number.
+ * @return NAEGELES_OK on success, NAEGELES_ERR_FUTURE_DATE if the LNMP is after as_of.
+ */
+static int compute_woa_result(naegeles_result_t* out, int32_t lnmp_days, int32_t as_of) {
+    STATS_TICK(woa_start);
+
+    // Whole days between the two calendar dates; no time zone or DST involved. as_of is any
+    // int32, so the difference is taken in 64 bits; the week count still fits an int.
+    const int64_t total_days = (int64_t)as_of - lnmp_days;
+    if (total_days < 0) {
+        out->status = NAEGELES_ERR_FUTURE_DATE;
+        STATS_STAGE(NAEGELES_STAGE_WOA, woa_start);
+        return NAEGELES_ERR_FUTURE_DATE;
+    }
+
+    out->woa_weeks = (int)(total_days / 7);
+    out->woa_days  = (int)(total_days % 7);
+    STATS_STAGE(NAEGELES_STAGE_WOA, woa_start);
+    return NAEGELES_OK;
+}
+
+/** Two-digit decimal strings "00" to "99", for writing numbers two digits at a time. */
+static const char digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/** Day number of 0000-01-01, the earliest date with a four-digit year. */
+#define FORMAT_MIN_DAY_NUMBER (-719528)
+
+/** Day number of 9999-12-31, the latest date with a four-digit year. */
+#define FORMAT_MAX_DAY_NUMBER 2932896
+
+/** Longest output of put_uint. */
+#define UINT_STR_MAX_LEN 10
+
+/**
+ * Writes two decimal digits.
+ * @param out Output position.
+ * @param value Value (0-99).
+ */
+static inline void put_2digits(char* out, unsigned value) {
+    memcpy(out, digit_pairs + 2 * value, 2);
+}
+
+/**
+ * Writes a civil date as dd/mm/yyyy, without a NUL.
+ * @param out Output position with room for DATE_STR_LEN bytes.
+ * @param day Day of month.
+ * @param month Month.
+ * @param year Year (0-9999).
+ */
+static inline void put_date(char* out, int day, int month, int year) {
+    put_2digits(out, (unsigned)day);
+    out[2] = '/';
+    put_2digits(out + 3, (unsigned)month);
+    out[5] = '/';
+    put_2digits(out + 6, (unsigned)year / 100);
+    put_2digits(out + 8, (unsigned)year % 100);
+}
+
+/**
+ * Writes an unsigned integer in decimal, without a NUL.
+ * @param out Output position with room for UINT_STR_MAX_LEN bytes.
+ * @param value Value to write.
+ * @return Number of bytes written.
+ */
+static inline size_t put_uint(char* out, uint32_t value) {
+    char digits[UINT_STR_MAX_LEN];
+    size_t n = sizeof(digits);
+    while (value >= 100) {
+        n -= 2;
+        put_2digits(digits + n, value % 100);
+        value /= 100;
+    }
+    if (value >= 10) {
+        n -= 2;
+        put_2digits(digits + n, value);
+    } else {
+        digits[--n] = (char)('0' + value);
+    }
+    memcpy(out, digits + n, sizeof(digits) - n);
+    return sizeof(digits) - n;
+}
+
+/**
+ * Writes a WOA as "N weeks" or "N weeks, M days" (singular for 1), without a NUL.
+ * @param out Output position with room for WOA_STR_MAX_LEN - 1 bytes.
+ * @param weeks Completed weeks.
+ * @param days Remaining days (0-6).
+ * @return Number of bytes written.
+ */
+static size_t put_woa(char* out, uint32_t weeks, uint32_t days) {
+    size_t n = put_uint(out, weeks);
+    memcpy(out + n, " weeks", 6);
+    n += weeks == 1 ? 5 : 6;
+
+    if (days > 0) {
+        memcpy(out + n, ", ", 2);
+        n += 2;
+        n += put_uint(out + n, days);
+        memcpy(out + n, " days", 5);
+        n += days == 1 ? 4 : 5;
+    }
+    return n;
+}
+
+_Static_assert(UINT_STR_MAX_LEN + 6 + 2 + 1 + 5 < WOA_STR_MAX_LEN, "put_woa must fit");
+
+/**
+ * Copies a NUL-terminated message, truncating it to the buffer.
+ * @param out Output buffer.
+ * @param out_size Size of the output buffer (at least 1).
+ * @param message Message to copy.
+ */
+static void put_message(char* out, size_t out_size, const char* message) {
+    size_t len = strnlen(message, out_size - 1);
+    memcpy(out, message, len);
+    out[len] = '\0';
+}
+
+/**
+ * Formats the EDD of a result as a NUL-terminated dd/mm/yyyy string.
+ * @param result Result with valid EDD fields.
+ * @param edd_out Output buffer, at least DATE_STR_MAX_LEN bytes.
+ */
+static void format_edd(const naegeles_result_t* result, char* edd_out) {
+    STATS_TICK(format_start);
+    put_date(edd_out, result->edd_day, result->edd_month, result->edd_year);
+    edd_out[DATE_STR_LEN] = '\0';
+    STATS_STAGE(NAEGELES_STAGE_FORMAT, format_start);
+}
+
+/**
+ * Formats the WOA of a result as a NUL-terminated "N weeks" or "N weeks, M days" string.
+ * @param result Result with valid WOA fields.
+ * @param woa_out Output buffer, at least WOA_STR_MAX_LEN bytes.
+ */
+static void format_woa(const naegeles_result_t* result, char* woa_out) {
+    STATS_TICK(format_start);
+    woa_out[put_woa(woa_out, (uint32_t)result->woa_weeks, (uint32_t)result->woa_days)] = '\0';
+    STATS_STAGE(NAEGELES_STAGE_FORMAT, format_start);
+}
+
+/**
+ * Writes a day number as dd/mm/yyyy into a caller-supplied buffer, without a NUL, so bulk
+ * output can be assembled in place.
+ * @param days Day number (days since 1970-01-01) of a date in years 0-9999.
+ * @param out Output position.
+ * @param out_size Bytes available at out.
+ * @return Number of bytes written (DATE_STR_LEN), or a negative error code.
+ */
+int naegeles_format_date(int32_t days, char* out, size_t out_size) {
+    if (out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+    if (days < FORMAT_MIN_DAY_NUMBER || days > FORMAT_MAX_DAY_NUMBER) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+    if (out_size < DATE_STR_LEN) {
+        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    }
+
+    int day = 0, month = 0, year = 0;
+    civil_from_days(days, &day, &month, &year);
+    put_date(out, day, month, year);
+    return DATE_STR_LEN;
+}
+
+/**
+ * Writes a WOA as "N weeks" or "N weeks, M days" into a caller-supplied buffer, without a NUL.
+ * @param weeks Completed weeks (non-negative).
+ * @param days Remaining days (0-6).
+ * @param out Output position.
+ * @param out_size Bytes available at out.
+ * @return Number of bytes written, or a negative error code.
+ */
+int naegeles_format_woa(int32_t weeks, int32_t days, char* out, size_t out_size) {
+    if (out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+    if (weeks < 0 || days < 0 || days > 6) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    if (out_size >= WOA_STR_MAX_LEN - 1) {
+        return (int)put_woa(out, (uint32_t)weeks, (uint32_t)days);
+    }
+
+    char woa[WOA_STR_MAX_LEN];
+    size_t len = put_woa(woa, (uint32_t)weeks, (uint32_t)days);
+    if (len > out_size) {
+        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    }
+    memcpy(out, woa, len);
+    return (int)len;
+}
+
+/**
+ * Writes an unsigned integer in decimal into a caller-supplied buffer, without a NUL.
+ * @param value Value to write.
+ * @param out Output position.
+ * @param out_size Bytes available at out.
+ * @return Number of bytes written, or a negative error code.
+ */
+int naegeles_format_uint(uint32_t value, char* out, size_t out_size) {
+    if (out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    if (out_size >= UINT_STR_MAX_LEN) {
+        return (int)put_uint(out, value);
+    }
+
+    char digits[UINT_STR_MAX_LEN];
+    size_t len = put_uint(digits, value);
+    if (len > out_size) {
+        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    }
+    memcpy(out, digits, len);
+    return (int)len;
+}
+
+/**
+ * Computes EDD and WOA as numbers, measuring WOA against an explicit reference date.
+ * The LNMP is parsed once and nothing is formatted.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param as_of Reference date as a day number (see naegeles_date_to_days).
+ * @param out Result to fill.
+ * @return NAEGELES_OK on success, error code otherwise (also stored in out->status).
+ */
+int naegeles_compute_result_asof(const char* lnmp, int32_t as_of, naegeles_result_t* out) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    int32_t lnmp_days = 0;
+    int result        = compute_edd_result(lnmp, out, &lnmp_days);
+    if (result != NAEGELES_OK) {
+        STATS_RETURN(result);
+    }
+
+    STATS_RETURN(compute_woa_result(out, lnmp_days, as_of));
+}
+
+/**
+ * Computes EDD and WOA as numbers, measuring WOA against today's date.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param out Result to fill.
+ * @return NAEGELES_OK on success, error code otherwise (also stored in out->status).
+ */
+int naegeles_compute_result(const char* lnmp, naegeles_result_t* out) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    int32_t today = 0;
+    if (!current_day_number(&today)) {
+        *out = (naegeles_result_t){.status = NAEGELES_ERR_SYSTEM_TIME};
+        STATS_RETURN(NAEGELES_ERR_SYSTEM_TIME);
+    }
+
+    STATS_RETURN(naegeles_compute_result_asof(lnmp, today, out));
+}
+
+/**
+ * Computes the Estimated Due Date (EDD) using Naegele's rule.
+ * Naegele's rule: Add 7 days, subtract 3 months (or add 9), add 1 year if needed.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param edd_out Output buffer for EDD string (dd/mm/yyyy format). Must be at least
+ * DATE_STR_MAX_LEN bytes.
+ * @param edd_out_size Size of the output buffer.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_compute_edd(const char* lnmp, char* edd_out, size_t edd_out_size) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || edd_out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    if (edd_out_size < DATE_STR_MAX_LEN) {
+        STATS_RETURN(NAEGELES_ERR_BUFFER_TOO_SMALL);
+    }
+
+    naegeles_result_t result;
+    int32_t lnmp_days = 0;
+
+    if (compute_edd_result(lnmp, &result, &lnmp_days) != NAEGELES_OK) {
+        put_message(edd_out, edd_out_size, "Invalid date");
+        STATS_RETURN(NAEGELES_ERR_INVALID_DATE);
+    }
+
+    format_edd(&result, edd_out);
+    STATS_RETURN(NAEGELES_OK);
+}
+
+/**
+ * Computes Weeks of Amenorrhea (WOA) from LNMP to an explicit reference date.
+ * WOA is calculated as the number of complete weeks and remaining days since LNMP.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param as_of Reference date as a day number (see naegeles_date_to_days).
+ * @param woa_out Output buffer for WOA string (e.g., "5 weeks" or "5 weeks, 3 days"). Must be at
+ * least WOA_STR_MAX_LEN bytes.
+ * @param woa_out_size Size of the output buffer.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_compute_woa_asof(const char* lnmp, int32_t as_of, char* woa_out,
+                              size_t woa_out_size) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || woa_out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    if (woa_out_size < WOA_STR_MAX_LEN) {
+        STATS_RETURN(NAEGELES_ERR_BUFFER_TOO_SMALL);
+    }
+
+    naegeles_result_t result;
+    switch (naegeles_compute_result_asof(lnmp, as_of, &result)) {
+        case NAEGELES_OK:
+            format_woa(&result, woa_out);
+            STATS_RETURN(NAEGELES_OK);
+        case NAEGELES_ERR_FUTURE_DATE:
+            put_message(woa_out, woa_out_size, "LNMP is in the future");
+            STATS_RETURN(NAEGELES_ERR_FUTURE_DATE);
+        default:
+            put_message(woa_out, woa_out_size, "Invalid date");
+            STATS_RETURN(NAEGELES_ERR_INVALID_DATE);
+    }
+}
+
+/**
+ * Computes Weeks of Amenorrhea (WOA) from LNMP to current date.
+ * WOA is calculated as the number of complete weeks and remaining days since LNMP.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param woa_out Output buffer for WOA string (e.g., "5 weeks" or "5 weeks, 3 days"). Must be at
+ * least WOA_STR_MAX_LEN bytes.
+ * @param woa_out_size Size of the output buffer.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_compute_woa(const char* lnmp, char* woa_out, size_t woa_out_size) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || woa_out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    if (woa_out_size < WOA_STR_MAX_LEN) {
+        STATS_RETURN(NAEGELES_ERR_BUFFER_TOO_SMALL);
+    }
+
+    // Get current date
+    int32_t today = 0;
+    if (!current_day_number(&today)) {
+        put_message(woa_out, woa_out_size, "System time error");
+        STATS_RETURN(NAEGELES_ERR_SYSTEM_TIME);
+    }
+
+    STATS_RETURN(naegeles_compute_woa_asof(lnmp, today, woa_out, woa_out_size));
+}
+
+/**
+ * Shared body of naegeles_compute_asof and naegeles_compute, after the argument checks. The EDD
+ * does not depend on the reference date, so it is written before today's date is read.
+ * @param lnmp LNMP in dd/mm/yyyy format.
+ * @param today Measure WOA against today's local date instead of as_of.
+ * @param as_of Reference date as a day number, unless today is set.
+ * @param edd_out EDD output buffer, at least DATE_STR_MAX_LEN bytes.
+ * @param edd_out_size Size of the EDD output buffer.
+ * @param woa_out WOA output buffer, at least WOA_STR_MAX_LEN bytes.
+ * @param woa_out_size Size of the WOA output buffer.
+ * @return NAEGELES_OK if both computations succeed, otherwise the first error encountered.
+ */
+static int compute_both(const char* lnmp, bool today, int32_t as_of, char* edd_out,
+                        size_t edd_out_size, char* woa_out, size_t woa_out_size) {
+    naegeles_result_t result;
+    int32_t lnmp_days = 0;
+
+    if (compute_edd_result(lnmp, &result, &lnmp_days) != NAEGELES_OK) {
+        put_message(edd_out, edd_out_size, "Invalid date");
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    format_edd(&result, edd_out);
+
+    if (today && !current_day_number(&as_of)) {
+        put_message(woa_out, woa_out_size, "System time error");
+        return NAEGELES_ERR_SYSTEM_TIME;
+    }
+
+    if (compute_woa_result(&result, lnmp_days, as_of) != NAEGELES_OK) {
+        put_message(woa_out, woa_out_size, "LNMP is in the future");
+        return NAEGELES_ERR_FUTURE_DATE;
+    }
+
+    format_woa(&result, woa_out);
+    return NAEGELES_OK;
+}
+
+/**
+ * Computes both EDD and WOA, measuring WOA against an explicit reference date.
+ * The LNMP is parsed and validated once and both outputs are derived from its day number.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param as_of Reference date as a day number (see naegeles_date_to_days).
+ * @param edd_out Output buffer for EDD string. Must be at least DATE_STR_MAX_LEN bytes.
+ * @param edd_out_size Size of the EDD output buffer.
+ * @param woa_out Output buffer for WOA string. Must be at least WOA_STR_MAX_LEN bytes.
+ * @param woa_out_size Size of the WOA output buffer.
+ * @return NAEGELES_OK if both computations succeed, otherwise the first error encountered.
+ */
+int naegeles_compute_asof(const char* lnmp, int32_t as_of, char* edd_out, size_t edd_out_size,
+                          char* woa_out, size_t woa_out_size) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || edd_out == NULL || woa_out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    if (edd_out_size < DATE_STR_MAX_LEN || woa_out_size < WOA_STR_MAX_LEN) {
+        STATS_RETURN(NAEGELES_ERR_BUFFER_TOO_SMALL);
+    }
+
+    STATS_RETURN(compute_both(lnmp, false, as_of, edd_out, edd_out_size, woa_out, woa_out_size));
+}
+
+/**
+ * Computes both EDD and WOA in a single call.
+ * The LNMP is parsed once; see naegeles_compute_asof.
+ *
+ * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
+ * @param edd_out Output buffer for EDD string. Must be at least DATE_STR_MAX_LEN bytes.
+ * @param edd_out_size Size of the EDD output buffer.
+ * @param woa_out Output buffer for WOA string. Must be at least WOA_STR_MAX_LEN bytes.
+ * @param woa_out_size Size of the WOA output buffer.
+ * @return NAEGELES_OK if both computations succeed, otherwise the first error encountered.
+ */
+int naegeles_compute(const char* lnmp, char* edd_out, size_t edd_out_size, char* woa_out,
+                     size_t woa_out_size) {
+    STATS_CALL_BEGIN();
+
+    if (lnmp == NULL || edd_out == NULL || woa_out == NULL) {
+        STATS_RETURN(NAEGELES_ERR_NULL_PARAM);
+    }
+
+    if (edd_out_size < DATE_STR_MAX_LEN || woa_out_size < WOA_STR_MAX_LEN) {
+        STATS_RETURN(NAEGELES_ERR_BUFFER_TOO_SMALL);
+    }
+
+    STATS_RETURN(compute_both(lnmp, true, 0, edd_out, edd_out_size, woa_out, woa_out_size));
+}
+
+/**
+ * Initializes a context with today's local date as the reference date.
+ * @param ctx Context to initialize.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_context_init(naegeles_context_t* ctx) {
+    if (ctx == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    if (!current_day_number(&ctx->as_of)) {
+        return NAEGELES_ERR_SYSTEM_TIME;
+    }
+
+    return NAEGELES_OK;
+}
+
+/**
+ * Initializes a context with an explicit reference date.
+ * @param ctx Context to initialize.
+ * @param as_of Reference date as a day number (see naegeles_date_to_days); any value, including
+ * dates outside 1900-2100.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_context_init_asof(naegeles_context_t* ctx, int32_t as_of) {
+    if (ctx == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    ctx->as_of = as_of;
+    return NAEGELES_OK;
+}
+
+/**
+ * Converts a civil date to a day number (days since 1970-01-01) for use with the batch API.
+ * @param day Day of month.
+ * @param month Month (1-12).
+ * @param year Year (1900-2100).
+ * @param days_out Output day number.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_date_to_days(int day, int month, int year, int32_t* days_out) {
+    if (days_out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    if (!is_valid_date(day, month, year)) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    *days_out = days_from_civil(day, month, year);
+    return NAEGELES_OK;
+}
+
+/**
+ * Converts a day number (days since 1970-01-01) back to a civil date.
+ * @param days Day number, e.g. an EDD produced by naegeles_compute_batch.
+ * @param day Output day of month.
+ * @param month Output month (1-12).
+ * @param year Output year.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_days_to_date(int32_t days, int* day, int* month, int* year) {
+    if (day == NULL || month == NULL || year == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    civil_from_days(days, day, month, year);
+    return NAEGELES_OK;
+}
+
+/**
+ * Parses a dd/mm/yyyy date string into a day number for use with the batch API.
+ * @param lnmp Date string in dd/mm/yyyy format.
+ * @param days_out Output day number.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_parse_date(const char* lnmp, int32_t* days_out) {
+    if (lnmp == NULL || days_out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    int day = 0, month = 0, year = 0;
+    if (!parse_date(lnmp, &day, &month, &year)) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    *days_out = days_from_civil(day, month, year);
+    return NAEGELES_OK;
+}
+
+/**
+ * Returns the layout of one date record: dd/mm/yyyy, dd-mm-yyyy, yyyy-mm-dd or yyyymmdd.
+ * Only the shape (length and separators) is checked, not the date itself.
+ * @param text Record bytes; no terminator needed.
+ * @param len Record length.
+ * @return A naegeles_date_layout_t other than NAEGELES_LAYOUT_AUTO, or an error code.
+ */
+int naegeles_detect_layout(const char* text, size_t len) {
+    if (text == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    naegeles_date_layout_t layout = detect_layout(text, len);
+    if (layout == NAEGELES_LAYOUT_AUTO || layout_length(layout) != len) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+    return (int)layout;
+}
+
+/**
+ * Parses one date record in a given layout into a day number.
+ * @param text Record bytes; no terminator needed.
+ * @param len Record length, which must match the layout.
+ * @param layout Record layout, or NAEGELES_LAYOUT_AUTO to detect it from this record.
+ * @param days_out Output day number.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_parse_date_layout(const char* text, size_t len, naegeles_date_layout_t layout,
+                               int32_t* days_out) {
+    if (text == NULL || days_out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    STATS_TICK(parse_start);
+    if (layout == NAEGELES_LAYOUT_AUTO) {
+        layout = detect_layout(text, len);
+    }
+
+    int day = 0, month = 0, year = 0;
+    bool parsed = layout >= NAEGELES_LAYOUT_DMY_SLASH && layout < NAEGELES_LAYOUT_AUTO &&
+                  len == layout_length(layout) &&
+                  parse_layout_fixed(layout, text, &day, &month, &year);
+    if (parsed) {
+        *days_out = days_from_civil(day, month, year);
+    }
+
+    STATS_STAGE(NAEGELES_STAGE_PARSE, parse_start);
+#ifdef NAEGELES_STATS
+    stats_add(STAT_PARSE_ROWS, 1);
+#endif
+    return parsed ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE;
+}
+
+/**
+ * Parses count fixed-width records of one layout. Inlined once per layout so each loop runs
+ * its dedicated parser.
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ * @param records Pointer to the first record.
+ * @param stride Distance in bytes between record starts.
+ * @param count Number of records.
+ * @param days_out Output day numbers.
+ * @param status Output per-row codes.
+ */
+static inline void parse_rows(naegeles_date_layout_t layout, const char* records, size_t stride,
+                              size_t count, int32_t* days_out, int32_t* status) {
+    for (size_t i = 0; i < count; i++) {
+        int day = 0, month = 0, year = 0;
+        bool ok     = parse_layout_fixed(layout, records + i * stride, &day, &month, &year);
+        days_out[i] = ok ? days_from_civil(day, month, year) : 0;
+        status[i]   = ok ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE;
+    }
+}
+
+/**
+ * Parses an array of fixed-width date records of one layout into day numbers.
+ * Records need no terminator: record i starts at records + i * stride and its first 10 bytes
+ * (8 for yyyymmdd) are parsed, so a column of a fixed-width extract can be passed in place.
+ * Invalid rows get day number 0 and status NAEGELES_ERR_INVALID_DATE.
+ *
+ * @param records Pointer to the first record.
+ * @param stride Distance in bytes between record starts (at least the layout's length).
+ * @param count Number of records.
+ * @param layout Record layout, or NAEGELES_LAYOUT_AUTO to detect it from the first record.
+ * @param days_out Output day numbers, count elements.
+ * @param status Output per-row naegeles_error_t codes, count elements.
+ * @return NAEGELES_OK if the batch was processed (check status per row), error code otherwise.
+ */
+int naegeles_parse_batch_layout(const char* records, size_t stride, size_t count,
+                                naegeles_date_layout_t layout, int32_t* days_out,
+                                int32_t* status) {
+    if (days_out == NULL || status == NULL || (records == NULL && count > 0)) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    if (layout == NAEGELES_LAYOUT_AUTO && count > 0) {
+        layout = detect_layout(records, stride);
+        if (layout == NAEGELES_LAYOUT_AUTO) {
+            return NAEGELES_ERR_INVALID_DATE;
+        }
+    }
+    if (layout < NAEGELES_LAYOUT_DMY_SLASH || layout > NAEGELES_LAYOUT_AUTO) {
+        return NAEGELES_ERR_INVALID_DATE;
+    }
+
+    if (stride < layout_length(layout)) {
+        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    }
+
+    STATS_TICK(parse_start);
+
+    switch (layout) {
+        case NAEGELES_LAYOUT_DMY_DASH:
+            parse_rows(NAEGELES_LAYOUT_DMY_DASH, records, stride, count, days_out, status);
+            break;
+        case NAEGELES_LAYOUT_ISO:
+            parse_rows(NAEGELES_LAYOUT_ISO, records, stride, count, days_out, status);
+            break;
+        case NAEGELES_LAYOUT_COMPACT:
+            parse_rows(NAEGELES_LAYOUT_COMPACT, records, stride, count, days_out, status);
+            break;
+        default:
+            parse_rows(NAEGELES_LAYOUT_DMY_SLASH, records, stride, count, days_out, status);
+            break;
+    }
+
+    STATS_STAGE(NAEGELES_STAGE_PARSE, parse_start);
+#ifdef NAEGELES_STATS
+    stats_add(STAT_PARSE_ROWS, count);
+#endif
+    return NAEGELES_OK;
+}
+
+/**
+ * Parses an array of fixed-width dd/mm/yyyy records into day numbers; see
+ * naegeles_parse_batch_layout.
+ *
+ * @param records Pointer to the first record.
+ * @param stride Distance in bytes between record starts (at least DATE_STR_LEN).
+ * @param count Number of records.
+ * @param days_out Output day numbers, count elements.
+ * @param status Output per-row naegeles_error_t codes, count elements.
+ * @return NAEGELES_OK if the batch was processed (check status per row), error code otherwise.
+ */
+int naegeles_parse_batch(const char* records, size_t stride, size_t count, int32_t* days_out,
+                         int32_t* status) {
+    return naegeles_parse_batch_layout(records, stride, count, NAEGELES_LAYOUT_DMY_SLASH,
+                                       days_out, status);
+}
+
+/**
+ * Computes one batch row with the scalar reference arithmetic.
+ * @param as_of Reference date day number.
+ * @param lnmp LNMP day number.
+ * @param out Output arrays.
+ * @param i Row index.
+ */
+static inline void batch_row(int32_t as_of, int32_t lnmp, const naegeles_batch_t* out, size_t i) {
+    // Every day number in this range is a valid date, so no civil conversion is needed
+    if (lnmp < MIN_DAY_NUMBER || lnmp > MAX_DAY_NUMBER) {
+        out->edd[i]       = 0;
+        out->woa_weeks[i] = 0;
+        out->woa_days[i]  = 0;
+        out->status[i]    = NAEGELES_ERR_INVALID_DATE;
+        return;
+    }
+
+    out->edd[i] = edd_from_lnmp(lnmp);
+
+    // 64 bits, as in compute_woa_result: as_of is not range-checked
+    const int64_t total_days = (int64_t)as_of - lnmp;
+    if (total_days < 0) {
+        out->woa_weeks[i] = 0;
+        out->woa_days[i]  = 0;
+        out->status[i]    = NAEGELES_ERR_FUTURE_DATE;
+        return;
+    }
+
+    out->woa_weeks[i] = (int32_t)(total_days / 7);
+    out->woa_days[i]  = (int32_t)(total_days % 7);
+    out->status[i]    = NAEGELES_OK;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(NAEGELES_NO_SIMD)
+#define HAVE_VECTOR_KERNEL 1
+
+/** Rows per vector group: one AVX2 register, or two SSE/NEON/WASM SIMD128 registers. */
+#define VEC_LANES 8
+
+typedef int32_t vec_i32 __attribute__((vector_size(VEC_LANES * sizeof(int32_t))));
+typedef uint32_t vec_u32 __attribute__((vector_size(VEC_LANES * sizeof(uint32_t))));
+
+/**
+ * First day (1900-03-01) of the window in which the vector kernel's leap rule holds: from here
+ * to VEC_WINDOW_LAST every fourth February has 29 days, so a date is one 1461-day cycle lookup.
+ */
+#define VEC_WINDOW_FIRST (YEAR_START(1900) + 59)
+
+/** Last day (2100-02-28) of the vector kernel's simple leap-rule window. */
+#define VEC_WINDOW_LAST (YEAR_START(2100) + 58)
+
+/** March-based years from 1900-03-01 to 2100-03-01; February 2100 has no leap day. */
+#define VEC_YEARS_TO_2100 200
+
+/** WOA day counts must stay below this for the divide-by-7 multiply to be exact. */
+#define VEC_MAX_WOA_DAYS (1 << 17)
+
+/**
+ * Computes groups of VEC_LANES rows with branch-free vector arithmetic.
+ * The LNMP + 7 date is split into 4-year cycles, year, March-based month and day with exact
+ * multiply-shift divisions, shifted 9 months, and reassembled into a day number; this matches
+ * naegele_rule, including its roll-over past short months. Groups containing a row outside
+ * the window (or an invalid row) are left to the scalar path.
+ * @param as_of Reference date; as_of - (VEC_WINDOW_FIRST - 7) must be below VEC_MAX_WOA_DAYS
+ * and (VEC_WINDOW_LAST - 7) - as_of at most VEC_MAX_WOA_DAYS, so no lane difference overflows.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param out Output arrays.
+ * @return Number of leading rows processed; the caller finishes the remainder.
+ */
+static inline __attribute__((always_inline)) size_t
+batch_vector_body(int32_t as_of, const int32_t* lnmp, size_t count, const naegeles_batch_t* out) {
+    size_t i = 0;
+    for (; i + VEC_LANES <= count; i += VEC_LANES) {
+        vec_i32 l;
+        memcpy(&l, lnmp + i, sizeof(l));
+
+        // Offset into the window; wrapping arithmetic, so extreme day numbers land outside it
+        const vec_i32 t      = (vec_i32)((vec_u32)l + (uint32_t)EDD_DAY_OFFSET -
+                                         (uint32_t)VEC_WINDOW_FIRST);
+        const vec_i32 in_win = (t >= 0) & (t <= VEC_WINDOW_LAST - VEC_WINDOW_FIRST);
+
+        bool all_in_window = true;
+        for (int k = 0; k < VEC_LANES; k++) {
+            all_in_window &= in_win[k] != 0;
+        }
+        if (!all_in_window) {
+            for (size_t j = i; j < i + VEC_LANES; j++) {
+                batch_row(as_of, lnmp[j], out, j);
+            }
+            continue;
+        }
 
-/** Maximum length for date string in dd/mm/yyyy format. */
-#define DATE_STR_MAX_LEN 16
+        // LNMP + 7 days as cycle, year, March-based month (0 = March) and day
+        const vec_i32 cycle = (t * 22967) >> 25;  // t / 1461
+        const vec_i32 r     = t - cycle * 1461;
+        vec_i32 yoff        = (r * 1437) >> 19;   // r / 365
+        yoff                = yoff - ((yoff > 3) & (yoff - 3));
+        const vec_i32 doy   = r - yoff * 365;
+        const vec_i32 mp    = ((doy * 5 + 2) * 857) >> 17;  // (5 * doy + 2) / 153
+        const vec_i32 day   = doy - (((mp * 153 + 2) * 1639) >> 13) + 1;  // (153 * mp + 2) / 5
 
-/** Maximum length for WOA result string. */
-#define WOA_STR_MAX_LEN 32
+        // Naegele's rule: +9 months, carrying into the next March-based year
+        vec_i32 mp_edd   = mp + (12 - EDD_MONTH_OFFSET);
+        const vec_i32 wrap = mp_edd >= 12;
+        mp_edd           = mp_edd - (wrap & 12);
+        const vec_i32 y  = cycle * 4 + yoff - wrap;  // wrap is -1 where the year carries
 
-/** Days to add to LMP day component for EDD calculation. */
-#define EDD_DAY_OFFSET 7
+        // Day number of the shifted date; (y >= 200) is -1 and drops the missing 29/02/2100
+        const vec_i32 edd = VEC_WINDOW_FIRST + y * 365 + (y >> 2) + (y >= VEC_YEARS_TO_2100) +
+                            (((mp_edd * 153 + 2) * 1639) >> 13) + day - 1;
 
-/** Months to adjust for EDD (subtract 3 or add 9). */
-#define EDD_MONTH_OFFSET 3
+        // WOA; negative day counts are future LNMPs and are zeroed
+        const vec_i32 diff   = as_of - l;
+        const vec_i32 future = diff < 0;
+        const vec_u32 total  = (vec_u32)(diff & ~future);
+        vec_i32 weeks        = (vec_i32)((total * 18725u) >> 17);  // total / 7, or one more
+        vec_i32 days         = (vec_i32)total - weeks * 7;
+        const vec_i32 over   = days < 0;
+        weeks                = weeks + over;
+        days                 = days + (over & 7);
 
-/** Return codes for API functions. */
-typedef enum {
-    NAEGELES_OK                   = 0,  /**< Operation successful. */
-    NAEGELES_ERR_NULL_PARAM       = -1, /**< NULL parameter provided. */
-    NAEGELES_ERR_INVALID_DATE     = -2, /**< Invalid date format or value. */
-    NAEGELES_ERR_DATE_CONVERSION  = -3, /**< Failed to convert date. */
-    NAEGELES_ERR_SYSTEM_TIME      = -4, /**< Failed to get system time. */
-    NAEGELES_ERR_FUTURE_DATE      = -5, /**< LNMP date is in the future. */
-    NAEGELES_ERR_BUFFER_TOO_SMALL = -6  /**< Output buffer too small. */
-} naegeles_error_t;
+        const vec_i32 weeks_out  = weeks & ~future;
+        const vec_i32 days_out   = days & ~future;
+        const vec_i32 status_out = future & NAEGELES_ERR_FUTURE_DATE;
+        memcpy(out->edd + i, &edd, sizeof(edd));
+        memcpy(out->woa_weeks + i, &weeks_out, sizeof(weeks_out));
+        memcpy(out->woa_days + i, &days_out, sizeof(days_out));
+        memcpy(out->status + i, &status_out, sizeof(status_out));
+    }
+    return i;
+}
 
 /**
- * Checks if a given year is a leap year.
- * @param year The year to check.
- * @return true if leap year, false otherwise.
+ * Vector kernel compiled for the baseline target: SSE2 on x86-64, NEON on AArch64, SIMD128 on
+ * WebAssembly built with -msimd128.
  */
-static bool is_leap_year(int year) {
-    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+static size_t batch_vector_generic(int32_t as_of, const int32_t* lnmp, size_t count,
+                                   const naegeles_batch_t* out) {
+    return batch_vector_body(as_of, lnmp, count, out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/** Vector kernel compiled for AVX2, selected at run time on CPUs that support it. */
+__attribute__((target("avx2"))) static size_t batch_vector_avx2(int32_t as_of,
+                                                                const int32_t* lnmp, size_t count,
+                                                                const naegeles_batch_t* out) {
+    return batch_vector_body(as_of, lnmp, count, out);
 }
+#endif
 
 /**
- * Returns the number of days in a given month for a given year.
- * @param month Month (1-12).
- * @param year Year to account for leap years.
- * @return Number of days in the month, or 0 if month is invalid.
+ * Runs the best vector kernel for this CPU over the leading full groups of a batch.
+ * @param as_of Reference date day number.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param out Output arrays.
+ * @return Number of leading rows processed (0 if as_of is outside the kernel's range).
  */
-static int days_in_month(int month, int year) {
-    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    if (month < 1 || month > 12) {
+static size_t batch_vector(int32_t as_of, const int32_t* lnmp, size_t count,
+                           const naegeles_batch_t* out) {
+    if (as_of > VEC_WINDOW_FIRST - EDD_DAY_OFFSET + (VEC_MAX_WOA_DAYS - 1) ||
+        as_of < VEC_WINDOW_LAST - EDD_DAY_OFFSET - VEC_MAX_WOA_DAYS) {
         return 0;
     }
-    if (month == 2 && is_leap_year(year)) {
-        return 29;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return batch_vector_avx2(as_of, lnmp, count, out);
     }
-    return days[month - 1];
+#endif
+    return batch_vector_generic(as_of, lnmp, count, out);
 }
 
+#endif  // vector kernel
+
 /**
- * Validates if a date is valid.
- * @param day Day of month (1-31).
- * @param month Month (1-12).
- * @param year Year (must be reasonable, e.g., 1900-2100).
- * @return true if valid, false otherwise.
+ * Runs the vector kernel, where available, and the scalar tail over a batch, without stats.
+ * @param as_of Reference date day number.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param out Output arrays.
  */
-static bool is_valid_date(int day, int month, int year) {
-    if (year < 1900 || year > 2100) {
-        return false;
+static void batch_kernel(int32_t as_of, const int32_t* lnmp, size_t count,
+                         const naegeles_batch_t* out) {
+    size_t i = 0;
+
+#ifdef HAVE_VECTOR_KERNEL
+    i = batch_vector(as_of, lnmp, count, out);
+#endif
+
+    for (; i < count; i++) {
+        batch_row(as_of, lnmp[i], out, i);
     }
-    if (month < 1 || month > 12) {
-        return false;
+}
+
+/**
+ * Computes EDD and WOA for an array of LNMP day numbers against the context's reference date.
+ * No strings are parsed or formatted. With GCC or Clang, full groups of rows run through a
+ * vector kernel (AVX2 when the CPU has it, otherwise the baseline SSE2/NEON/SIMD128 build)
+ * that gives bit-identical results to the scalar path; define NAEGELES_NO_SIMD to disable it.
+ *
+ * Rows that fail get a per-row status of NAEGELES_ERR_INVALID_DATE (LNMP outside 1900-2100)
+ * or NAEGELES_ERR_FUTURE_DATE (EDD is still filled in, WOA is zeroed).
+ *
+ * @param ctx Context holding the reference date.
+ * @param lnmp Array of LNMP day numbers (days since 1970-01-01).
+ * @param count Number of rows in lnmp.
+ * @param out Output arrays, each with room for count elements.
+ * @return NAEGELES_OK if the batch was processed (check out->status per row), error code otherwise.
+ */
+int naegeles_compute_batch_ctx(const naegeles_context_t* ctx, const int32_t* lnmp, size_t count,
+                               const naegeles_batch_t* out) {
+    if (ctx == NULL || out == NULL || out->edd == NULL || out->woa_weeks == NULL ||
+        out->woa_days == NULL || out->status == NULL || (lnmp == NULL && count > 0)) {
+        return NAEGELES_ERR_NULL_PARAM;
     }
-    if (day < 1 || day > days_in_month(month, year)) {
-        return false;
+
+    STATS_TICK(batch_start);
+    batch_kernel(ctx->as_of, lnmp, count, out);
+
+    STATS_STAGE(NAEGELES_STAGE_BATCH, batch_start);
+#ifdef NAEGELES_STATS
+    stats_add(STAT_BATCH_CALLS, 1);
+    stats_add(STAT_BATCH_ROWS, count);
+    for (size_t i = 0; i < count; i++) {
+        stats_count_error(out->status[i]);
     }
-    return true;
+#endif
+    return NAEGELES_OK;
 }
 
+/** Widest LNMP span naegeles_compute_batch_dedup builds a table for (256 KiB, L2-resident). */
+#define DEDUP_MAX_SPAN 16384
+
+/** Rows per day of span below which the table costs more than it saves. */
+#define DEDUP_MIN_ROWS_PER_DAY 4
+
+/** Days computed per kernel call while building the table. */
+#define DEDUP_CHUNK_DAYS 256
+
 /**
- * Parses a date string in dd/mm/yyyy format.
- * @param lnmp Input date string.
- * @param day Output day.
- * @param month Output month.
- * @param year Output year.
- * @return true on successful parse and validation, false otherwise.
+ * Finds the first and last valid LNMP of a batch. Invalid rows are clamped to the far end of
+ * the range instead of branched on, so the loop vectorizes.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param first Output first valid LNMP; MAX_DAY_NUMBER if there is none.
+ * @param last Output last valid LNMP; MIN_DAY_NUMBER if there is none.
  */
-static bool parse_date(const char* lnmp, int* day, int* month, int* year) {
-    if (lnmp == NULL || day == NULL || month == NULL || year == NULL) {
-        return false;
+static inline __attribute__((always_inline)) void
+dedup_span_body(const int32_t* lnmp, size_t count, int32_t* first, int32_t* last) {
+    int32_t lo = MAX_DAY_NUMBER;
+    int32_t hi = MIN_DAY_NUMBER;
+    for (size_t i = 0; i < count; i++) {
+        const int32_t day   = lnmp[i];
+        const int32_t valid = -(int32_t)((uint32_t)day - (uint32_t)MIN_DAY_NUMBER <=
+                                         (uint32_t)(MAX_DAY_NUMBER - MIN_DAY_NUMBER));
+        const int32_t low   = (day & valid) | (MAX_DAY_NUMBER & ~valid);
+        const int32_t high  = (day & valid) | (MIN_DAY_NUMBER & ~valid);
+        lo                  = low < lo ? low : lo;
+        hi                  = high > hi ? high : hi;
     }
+    *first = lo;
+    *last  = hi;
+}
 
-    // Expected format: dd/mm/yyyy (10 characters minimum)
-    if (strlen(lnmp) != 10) {
-        return false;
-    }
+#if defined(__x86_64__) || defined(__i386__)
+/** dedup_span_body compiled for AVX2, which has the 32-bit min and max SSE2 lacks. */
+__attribute__((target("avx2"))) static void dedup_span_avx2(const int32_t* lnmp, size_t count,
+                                                            int32_t* first, int32_t* last) {
+    dedup_span_body(lnmp, count, first, last);
+}
+#endif
 
-    // Parse using sscanf with strict format checking
-    int parsed = sscanf(lnmp, "%2d/%2d/%4d", day, month, year);
-    if (parsed != 3) {
-        return false;
+/**
+ * Finds the first and last valid LNMP of a batch with the best build for this CPU.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param first Output first valid LNMP; MAX_DAY_NUMBER if there is none.
+ * @param last Output last valid LNMP; MIN_DAY_NUMBER if there is none.
+ */
+static void dedup_span(const int32_t* lnmp, size_t count, int32_t* first, int32_t* last) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        dedup_span_avx2(lnmp, count, first, last);
+        return;
     }
+#endif
+    dedup_span_body(lnmp, count, first, last);
+}
 
-    // Validate the parsed date
-    if (!is_valid_date(*day, *month, *year)) {
-        return false;
+/**
+ * Computes every day from first to first + span - 1 into a struct-of-arrays table, followed by
+ * one entry for LNMPs outside that span.
+ * @param as_of Reference date day number.
+ * @param first First day of the span.
+ * @param span Days in the span.
+ * @param table Table arrays, each with room for span + 1 entries.
+ */
+static void dedup_build(int32_t as_of, int32_t first, size_t span, const naegeles_batch_t* table) {
+    int32_t days[DEDUP_CHUNK_DAYS];
+    for (size_t start = 0; start < span; start += DEDUP_CHUNK_DAYS) {
+        const size_t n = span - start < DEDUP_CHUNK_DAYS ? span - start : DEDUP_CHUNK_DAYS;
+        for (size_t i = 0; i < n; i++) {
+            days[i] = first + (int32_t)(start + i);
+        }
+
+        const naegeles_batch_t chunk = {table->edd + start, table->woa_weeks + start,
+                                        table->woa_days + start, table->status + start};
+        batch_kernel(as_of, days, n, &chunk);
     }
 
-    return true;
+    // Every valid LNMP of the batch is inside the span, so the rest are invalid
+    table->edd[span]       = 0;
+    table->woa_weeks[span] = 0;
+    table->woa_days[span]  = 0;
+    table->status[span]    = NAEGELES_ERR_INVALID_DATE;
 }
 
 /**
- * Computes the Estimated Due Date (EDD) using Naegele's rule.
- * Naegele's rule: Add 7 days, subtract 3 months (or add 9), add 1 year if needed.
+ * Scatters table entries back to the rows of a batch. The arrays are restrict parameters,
+ * which GCC trusts when vectorizing (restrict locals and struct members are not enough once
+ * this is inlined), and the offsets are 32-bit: only the table loads stay scalar.
+ * @param lnmp LNMP day numbers.
+ * @param count Number of rows.
+ * @param first First day of the table's span.
+ * @param span Days in the span; entry span is the invalid row.
+ * @param t_edd, t_weeks, t_days, t_status Table arrays built by dedup_build.
+ * @param edd, weeks, days, status Output arrays.
+ */
+static void dedup_scatter(const int32_t* restrict lnmp, size_t count, int32_t first,
+                          uint32_t span, const int32_t* restrict t_edd,
+                          const int32_t* restrict t_weeks, const int32_t* restrict t_days,
+                          const int32_t* restrict t_status, int32_t* restrict edd,
+                          int32_t* restrict weeks, int32_t* restrict days,
+                          int32_t* restrict status) {
+    // Out-of-span LNMPs, including INT32_MIN, wrap to large offsets and hit the last entry
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t offset = (uint32_t)lnmp[i] - (uint32_t)first;
+        const uint32_t entry  = offset < span ? offset : span;
+        edd[i]                = t_edd[entry];
+        weeks[i]              = t_weeks[entry];
+        days[i]               = t_days[entry];
+        status[i]             = t_status[entry];
+    }
+}
+
+/**
+ * Computes EDD and WOA for an array of LNMP day numbers like naegeles_compute_batch_ctx, but
+ * computes each distinct day once. Registry extracts cluster in a narrow window of LNMPs, so
+ * one pass finds the span of valid LNMPs, every day of the span is computed into a small
+ * table, and a second pass scatters table entries back to the rows. Batches whose span is too
+ * wide (over 16384 days, or more than a quarter of the row count) go straight to the kernel,
+ * as do batches whose table cannot be allocated. Results are identical either way.
  *
- * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
- * @param edd_out Output buffer for EDD string (dd/mm/yyyy format). Must be at least
- * DATE_STR_MAX_LEN bytes.
- * @param edd_out_size Size of the output buffer.
- * @return NAEGELES_OK on success, error code otherwise.
+ * @param ctx Context holding the reference date.
+ * @param lnmp Array of LNMP day numbers (days since 1970-01-01).
+ * @param count Number of rows in lnmp.
+ * @param out Output arrays, each with room for count elements.
+ * @return NAEGELES_OK if the batch was processed (check out->status per row), error code otherwise.
  */
-int naegeles_compute_edd(const char* lnmp, char* edd_out, size_t edd_out_size) {
-    if (lnmp == NULL || edd_out == NULL) {
+int naegeles_compute_batch_dedup(const naegeles_context_t* ctx, const int32_t* lnmp,
+                                 size_t count, const naegeles_batch_t* out) {
+    if (ctx == NULL || out == NULL || out->edd == NULL || out->woa_weeks == NULL ||
+        out->woa_days == NULL || out->status == NULL || (lnmp == NULL && count > 0)) {
         return NAEGELES_ERR_NULL_PARAM;
     }
 
-    if (edd_out_size < DATE_STR_MAX_LEN) {
-        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    STATS_TICK(batch_start);
+    int32_t first = 0, last = 0;
+    dedup_span(lnmp, count, &first, &last);
+
+    const size_t span = last >= first ? (size_t)(last - first) + 1 : 0;
+    int32_t* memory   = NULL;
+    if (span <= DEDUP_MAX_SPAN && span <= count / DEDUP_MIN_ROWS_PER_DAY) {
+        memory = malloc(4 * (span + 1) * sizeof(int32_t));
     }
 
-    int day = 0, month = 0, year = 0;
+    if (memory != NULL) {
+        const naegeles_batch_t table = {memory, memory + (span + 1), memory + 2 * (span + 1),
+                                        memory + 3 * (span + 1)};
+        dedup_build(ctx->as_of, first, span, &table);
+        dedup_scatter(lnmp, count, first, (uint32_t)span, table.edd, table.woa_weeks,
+                      table.woa_days, table.status, out->edd, out->woa_weeks, out->woa_days,
+                      out->status);
+        free(memory);
+    } else {
+        batch_kernel(ctx->as_of, lnmp, count, out);
+    }
 
-    if (!parse_date(lnmp, &day, &month, &year)) {
-        snprintf(edd_out, edd_out_size, "Invalid date");
-        return NAEGELES_ERR_INVALID_DATE;
+    STATS_STAGE(NAEGELES_STAGE_BATCH, batch_start);
+#ifdef NAEGELES_STATS
+    stats_add(STAT_BATCH_CALLS, 1);
+    stats_add(STAT_BATCH_ROWS, count);
+    for (size_t i = 0; i < count; i++) {
+        stats_count_error(out->status[i]);
+    }
+#endif
+    return NAEGELES_OK;
+}
+
+/**
+ * Computes EDD and WOA for an array of LNMP day numbers against today's date.
+ * The system clock is read once for the whole batch, so every row is measured against the
+ * same reference date. See naegeles_compute_batch_ctx.
+ *
+ * @param lnmp Array of LNMP day numbers (days since 1970-01-01).
+ * @param count Number of rows in lnmp.
+ * @param out Output arrays, each with room for count elements.
+ * @return NAEGELES_OK if the batch was processed (check out->status per row), error code otherwise.
+ */
+int naegeles_compute_batch(const int32_t* lnmp, size_t count, const naegeles_batch_t* out) {
+    naegeles_context_t ctx;
+    int result = naegeles_context_init(&ctx);
+    if (result != NAEGELES_OK) {
+        return result;
     }
 
-    int max_days = days_in_month(month, year);
+    return naegeles_compute_batch_ctx(&ctx, lnmp, count, out);
+}
 
-    // Apply Naegele's rule: +7 days, -3 months (or +9 if month <= 3)
-    day += EDD_DAY_OFFSET;
+/**
+ * Tells whether a row's batch result changes between two reference dates. EDDs do not depend
+ * on the reference date and invalid LNMPs stay invalid, so only the future/past side and the
+ * WOA can change; for a one-day step in weeks mode this is (as_of - lnmp) % 7 == 0.
+ * @param prev_as_of Previous reference date.
+ * @param as_of New reference date.
+ * @param lnmp LNMP day number.
+ * @param change Fields compared.
+ * @return true if the row's status, weeks or (with NAEGELES_CHANGED_DAYS) days differ.
+ */
+static inline bool row_changed(int32_t prev_as_of, int32_t as_of, int32_t lnmp,
+                               naegeles_change_t change) {
+    if (lnmp < MIN_DAY_NUMBER || lnmp > MAX_DAY_NUMBER) {
+        return false;
+    }
 
-    // Handle month adjustment
-    if (month > 3) {
-        month -= EDD_MONTH_OFFSET;
-    } else {
-        month += (12 - EDD_MONTH_OFFSET);  // Add 9 months
-        year -= 1;                         // Temporarily go back a year
+    // 64-bit, like batch_row, so extreme reference dates cannot wrap
+    const int64_t before = (int64_t)prev_as_of - lnmp;
+    const int64_t after  = (int64_t)as_of - lnmp;
+    if (before < 0 || after < 0) {
+        return (before < 0) != (after < 0);
     }
+    return change == NAEGELES_CHANGED_DAYS ? before != after
+                                           : (uint64_t)before / 7 != (uint64_t)after / 7;
+}
 
-    // Handle day overflow into next month(s)
-    while (day > max_days) {
-        day -= max_days;
-        month++;
-        if (month > 12) {
-            month = 1;
-            year++;
-        }
-        max_days = days_in_month(month, year);
+/**
+ * Lists the rows whose naegeles_compute_batch_ctx result at ctx differs from their result at
+ * prev_as_of, so an incremental run only has to rewrite those. Nothing is computed beyond the
+ * comparison: call the batch kernel for the rows that are needed.
+ *
+ * @param ctx Context holding the new reference date.
+ * @param prev_as_of Reference date of the previous run, as a day number.
+ * @param lnmp Array of LNMP day numbers (days since 1970-01-01).
+ * @param count Number of rows in lnmp.
+ * @param change NAEGELES_CHANGED_WEEKS to ignore day-only changes, NAEGELES_CHANGED_DAYS to
+ * report any WOA change.
+ * @param rows_out Indices of the changed rows, ascending; room for count elements.
+ * @param changed_out Number of indices written.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_select_changed(const naegeles_context_t* ctx, int32_t prev_as_of,
+                            const int32_t* lnmp, size_t count, naegeles_change_t change,
+                            size_t* rows_out, size_t* changed_out) {
+    if (ctx == NULL || rows_out == NULL || changed_out == NULL || (lnmp == NULL && count > 0)) {
+        return NAEGELES_ERR_NULL_PARAM;
     }
 
-    // Add 1 year to compensate for the -3 months adjustment
-    year += 1;
+    // Every index is stored and the cursor only advances past changed rows, so the loop has
+    // no data-dependent branch
+    const int32_t as_of = ctx->as_of;
+    size_t changed      = 0;
+    for (size_t i = 0; i < count; i++) {
+        rows_out[changed] = i;
+        changed += row_changed(prev_as_of, as_of, lnmp[i], change);
+    }
 
-    // Format the result
-    snprintf(edd_out, edd_out_size, "%02d/%02d/%04d", day, month, year);
+    *changed_out = changed;
     return NAEGELES_OK;
 }
 
+/** Days from the LMP-equivalent start of gestation to the EDD for the linear methods. */
+#define METHOD_TERM_DAYS 280
+
+/** Rows per kernel call in naegeles_compute_batch_methods. */
+#define METHOD_CHUNK_ROWS 256
+
 /**
- * Computes Weeks of Amenorrhea (WOA) from LNMP to current date.
- * WOA is calculated as the number of complete weeks and remaining days since LNMP.
+ * Gestational age in days at crown-rump lengths of 10 to 84 mm:
+ * round(8.052 * sqrt(CRL mm) + 23.73) (Robinson and Fleming, 1975).
+ */
+static const int16_t crl_ga_days[] = {
+    49, 50, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 61, 62, 63, 64, 65, 66, 66, 67, 68, 69, 69, 70,
+    71, 71, 72, 73, 73, 74, 75, 75, 76, 77, 77, 78, 78, 79, 80, 80, 81, 81, 82, 82, 83, 83, 84, 85,
+    85, 86, 86, 87, 87, 88, 88, 89, 89, 90, 90, 91, 91, 92, 92, 93, 93, 93, 94, 94, 95, 95, 96, 96,
+    97, 97, 98,
+};
+
+/**
+ * Gestational age in days at biparietal diameters of 20 to 100 mm:
+ * round(7 * (9.54 + 1.482 * BPD cm + 0.1676 * BPD cm^2)) (Hadlock et al., 1982).
+ */
+static const int16_t bpd_ga_days[] = {
+    92, 94, 95, 97, 98, 100, 102, 103, 105, 107, 108, 110, 112, 114, 116, 117, 119, 121, 123, 125,
+    127, 129, 131, 133, 135, 137, 139, 141, 144, 146, 148, 150, 152, 155, 157, 159, 162, 164, 166,
+    169, 171, 174, 176, 179, 181, 184, 186, 189, 192, 194, 197, 200, 202, 205, 208, 211, 213, 216,
+    219, 222, 225, 228, 231, 234, 237, 240, 243, 246, 249, 252, 255, 258, 262, 265, 268, 271, 274,
+    278, 281, 284, 288,
+};
+
+_Static_assert(sizeof(crl_ga_days) / sizeof(crl_ga_days[0]) == 84 - 10 + 1, "CRL 10-84 mm");
+_Static_assert(sizeof(bpd_ga_days) / sizeof(bpd_ga_days[0]) == 100 - 20 + 1, "BPD 20-100 mm");
+
+/**
+ * Coefficients reducing a dating method to two day numbers per row: the origin (the
+ * LMP-equivalent start of gestation, which WOA is counted from) and, for the Naegele family,
+ * the anchor that Naegele's rule is applied to. With q = min(param, param_clamp):
+ *   origin = date + origin_offset + origin_per_param * q - ga_days[param - param_min]
+ *   anchor = origin + anchor_offset + anchor_per_param * q
+ *   EDD    = civil ? naegele_rule(anchor) : origin + METHOD_TERM_DAYS
+ */
+typedef struct {
+    uint8_t param_min;        /**< Smallest valid parameter. */
+    uint8_t param_max;        /**< Largest valid parameter. */
+    uint8_t param_clamp;      /**< Parameter cap for the linear terms. */
+    bool civil;               /**< EDD by Naegele's rule on the anchor. */
+    int8_t origin_offset;     /**< Days from the row date to the origin. */
+    int8_t origin_per_param;  /**< Origin days per parameter unit. */
+    int8_t anchor_offset;     /**< Days from the origin to the anchor. */
+    int8_t anchor_per_param;  /**< Anchor days per parameter unit. */
+    const int16_t* ga_days;   /**< Gestational age at the row date per parameter, or NULL. */
+} method_rule_t;
+
+/** Rules indexed by naegeles_method_t; the extra last entry rejects unknown methods. */
+static const method_rule_t method_rules[NAEGELES_METHOD_COUNT + 1] = {
+    [NAEGELES_METHOD_NAEGELE]    = {0, UINT8_MAX, 0, true, 0, 0, 0, 0, NULL},
+    [NAEGELES_METHOD_CYCLE]      = {21, 45, UINT8_MAX, true, -28, 1, 0, 0, NULL},
+    [NAEGELES_METHOD_MITTENDORF] = {0, UINT8_MAX, 1, true, 0, 0, 15 - EDD_DAY_OFFSET, -5, NULL},
+    [NAEGELES_METHOD_CONCEPTION] = {0, UINT8_MAX, 0, false, -14, 0, 0, 0, NULL},
+    [NAEGELES_METHOD_IVF]        = {2, 7, UINT8_MAX, false, -14, -1, 0, 0, NULL},
+    [NAEGELES_METHOD_CRL]        = {10, 84, 0, false, 0, 0, 0, 0, crl_ga_days},
+    [NAEGELES_METHOD_BPD]        = {20, 100, 0, false, 0, 0, 0, 0, bpd_ga_days},
+    [NAEGELES_METHOD_COUNT]      = {1, 0, 0, false, 0, 0, 0, 0, NULL},
+};
+
+/**
+ * Computes EDD and WOA for rows dated by different methods in one pass, like
+ * naegeles_compute_batch_ctx. Every method reduces to the same two day numbers through
+ * method_rules: the Naegele family's EDDs all go through the vector kernel (on the shifted
+ * anchor), the linear ones are a fixed distance from the origin, and WOA is as_of - origin for
+ * every row, so mixed-method batches need no per-method passes. Rows with
+ * NAEGELES_METHOD_NAEGELE give exactly the naegeles_compute_batch_ctx result.
  *
- * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
- * @param woa_out Output buffer for WOA string (e.g., "5 weeks" or "5 weeks, 3 days"). Must be at
- * least WOA_STR_MAX_LEN bytes.
- * @param woa_out_size Size of the output buffer.
- * @return NAEGELES_OK on success, error code otherwise.
+ * Rows fail with NAEGELES_ERR_INVALID_DATE if the date is outside 1900-2100, the method is
+ * unknown, the parameter is out of range, or a Naegele-family anchor leaves 1900-2100; and with
+ * NAEGELES_ERR_FUTURE_DATE (EDD filled in, WOA zeroed) if the origin is after as_of.
+ *
+ * @param ctx Context holding the reference date.
+ * @param date Array of row dates as day numbers; what the date is depends on the method.
+ * @param method Array of naegeles_method_t values.
+ * @param param Array of method parameters, or NULL for all zero.
+ * @param count Number of rows.
+ * @param out Output arrays, each with room for count elements.
+ * @return NAEGELES_OK if the batch was processed (check out->status per row), error code otherwise.
  */
-int naegeles_compute_woa(const char* lnmp, char* woa_out, size_t woa_out_size) {
-    if (lnmp == NULL || woa_out == NULL) {
+int naegeles_compute_batch_methods(const naegeles_context_t* ctx, const int32_t* date,
+                                   const uint8_t* method, const uint8_t* param, size_t count,
+                                   const naegeles_batch_t* out) {
+    if (ctx == NULL || out == NULL || out->edd == NULL || out->woa_weeks == NULL ||
+        out->woa_days == NULL || out->status == NULL ||
+        ((date == NULL || method == NULL) && count > 0)) {
         return NAEGELES_ERR_NULL_PARAM;
     }
 
-    if (woa_out_size < WOA_STR_MAX_LEN) {
-        return NAEGELES_ERR_BUFFER_TOO_SMALL;
+    const int32_t as_of = ctx->as_of;
+    STATS_TICK(batch_start);
+
+    for (size_t start = 0; start < count; start += METHOD_CHUNK_ROWS) {
+        const size_t n = count - start < METHOD_CHUNK_ROWS ? count - start : METHOD_CHUNK_ROWS;
+        int32_t anchor[METHOD_CHUNK_ROWS], origin[METHOD_CHUNK_ROWS];
+        bool valid[METHOD_CHUNK_ROWS], civil[METHOD_CHUNK_ROWS];
+
+        // Reduce every row to its origin and anchor. Rows without a civil anchor get day 0, which
+        // keeps their group on the vector path, and invalid rows a zero origin so nothing overflows
+        for (size_t i = 0; i < n; i++) {
+            const size_t row       = start + i;
+            const unsigned m       = method[row] < NAEGELES_METHOD_COUNT ? method[row]
+                                                                         : NAEGELES_METHOD_COUNT;
+            const method_rule_t* r = &method_rules[m];
+            const int p            = param != NULL ? param[row] : 0;
+            const int q            = p < r->param_clamp ? p : r->param_clamp;
+            const int32_t d        = date[row];
+            const bool ok          = d >= MIN_DAY_NUMBER && d <= MAX_DAY_NUMBER &&
+                                     p >= r->param_min && p <= r->param_max;
+            const int ga           = r->ga_days != NULL && ok ? r->ga_days[p - r->param_min] : 0;
+
+            valid[i]  = ok;
+            civil[i]  = r->civil;
+            origin[i] = ok ? d + r->origin_offset + r->origin_per_param * q - ga : 0;
+            anchor[i] = ok && r->civil ? origin[i] + r->anchor_offset + r->anchor_per_param * q
+                                       : 0;
+        }
+
+        const naegeles_batch_t chunk = {out->edd + start, out->woa_weeks + start,
+                                        out->woa_days + start, out->status + start};
+        batch_kernel(as_of, anchor, n, &chunk);
+
+        // The kernel's EDDs stand for the Naegele family; everything else follows the origin
+        for (size_t i = 0; i < n; i++) {
+            const bool anchored = !civil[i] || chunk.status[i] != NAEGELES_ERR_INVALID_DATE;
+            const bool ok       = valid[i] && anchored;
+            const int64_t total = (int64_t)as_of - origin[i];
+            const uint64_t past = ok && total >= 0 ? (uint64_t)total : 0;
+            const int32_t edd   = civil[i] ? chunk.edd[i] : origin[i] + METHOD_TERM_DAYS;
+
+            chunk.edd[i]       = ok ? edd : 0;
+            chunk.woa_weeks[i] = (int32_t)(past / 7);
+            chunk.woa_days[i]  = (int32_t)(past % 7);
+            chunk.status[i]    = !ok         ? NAEGELES_ERR_INVALID_DATE
+                                 : total < 0 ? NAEGELES_ERR_FUTURE_DATE
+                                             : NAEGELES_OK;
+        }
     }
 
-    int day = 0, month = 0, year = 0;
+    STATS_STAGE(NAEGELES_STAGE_BATCH, batch_start);
+#ifdef NAEGELES_STATS
+    stats_add(STAT_BATCH_CALLS, 1);
+    stats_add(STAT_BATCH_ROWS, count);
+    for (size_t i = 0; i < count; i++) {
+        stats_count_error(out->status[i]);
+    }
+#endif
+    return NAEGELES_OK;
+}
 
-    if (!parse_date(lnmp, &day, &month, &year)) {
-        snprintf(woa_out, woa_out_size, "Invalid date");
-        return NAEGELES_ERR_INVALID_DATE;
+#ifndef WASM_BUILD
+
+/** Smallest slice worth handing to a separate thread in naegeles_compute_batch_parallel. */
+#define PARALLEL_MIN_ROWS 16384
+
+/**
+ * A naegeles_run_tasks call queued on the worker pool. Its tasks are handed out one index at a
+ * time, so a worker can take the next task of the same job.
+ */
+typedef struct pool_job {
+    void (*task)(void* arg, unsigned index);
+    void* arg;
+    unsigned queued;       /**< Tasks available to the pool: indices 0 to queued - 1. */
+    unsigned next;         /**< Next index to hand out, guarded by the lock. */
+    unsigned pending;      /**< Handed-out or queued tasks not yet finished, guarded by the lock. */
+    struct pool_job* link; /**< Next queued job. */
+} pool_job_t;
+
+/**
+ * Worker pool shared by every naegeles_run_tasks call (and so naegeles_compute_batch_parallel).
+ * Workers are started on first use, grown to the largest thread count requested so far, and
+ * kept for the life of the process, so a call only queues its job and wakes them.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work; /**< Signaled when a job is queued. */
+    pthread_cond_t done; /**< Broadcast when a task finishes. */
+    pool_job_t* head;    /**< Jobs with tasks still to hand out, oldest first. */
+    pool_job_t* tail;
+    unsigned workers;    /**< Workers started. */
+} task_pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+               NULL, NULL, 0};
+
+/**
+ * Hands out the next task of the oldest queued job, dequeuing the job once its last task is
+ * taken; the pool lock must be held.
+ * @param index Output task index.
+ * @return The job, or NULL if the queue is empty.
+ */
+static pool_job_t* task_pool_take(unsigned* index) {
+    pool_job_t* job = task_pool.head;
+    if (job != NULL) {
+        *index = job->next++;
+        if (job->next == job->queued) {
+            task_pool.head = job->link;
+            if (task_pool.head == NULL) {
+                task_pool.tail = NULL;
+            }
+        }
     }
+    return job;
+}
 
-    // Convert LNMP to time_t using mktime
-    struct tm lnmp_tm = {0};
-    lnmp_tm.tm_year   = year - 1900;  // Years since 1900
-    lnmp_tm.tm_mon    = month - 1;    // Months since January (0-11)
-    lnmp_tm.tm_mday   = day;
-    lnmp_tm.tm_hour   = 0;
-    lnmp_tm.tm_min    = 0;
-    lnmp_tm.tm_sec    = 0;
-    lnmp_tm.tm_isdst  = -1;  // Let mktime determine DST
+/**
+ * Runs a task taken off the queue and marks it finished; called and returns with the pool
+ * lock held. The job belongs to a caller waiting on its pending count, so it is not touched
+ * once that count is updated.
+ * @param job Job of the task.
+ * @param index Task index.
+ */
+static void task_pool_run(pool_job_t* job, unsigned index) {
+    pthread_mutex_unlock(&task_pool.lock);
+    job->task(job->arg, index);
+    pthread_mutex_lock(&task_pool.lock);
 
-    time_t lnmp_time = mktime(&lnmp_tm);
-    if (lnmp_time == (time_t)-1) {
-        snprintf(woa_out, woa_out_size, "Date conversion error");
-        return NAEGELES_ERR_DATE_CONVERSION;
+    if (--job->pending == 0) {
+        pthread_cond_broadcast(&task_pool.done);
     }
+}
 
-    // Get current time
-    time_t current_time = time(NULL);
-    if (current_time == (time_t)-1) {
-        snprintf(woa_out, woa_out_size, "System time error");
-        return NAEGELES_ERR_SYSTEM_TIME;
+/**
+ * Pool worker: runs queued tasks until the process exits.
+ * @param arg Unused.
+ * @return Never returns.
+ */
+static void* task_pool_worker(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&task_pool.lock);
+    for (;;) {
+        unsigned index  = 0;
+        pool_job_t* job = task_pool_take(&index);
+        if (job == NULL) {
+            pthread_cond_wait(&task_pool.work, &task_pool.lock);
+            continue;
+        }
+        task_pool_run(job, index);
     }
+    return NULL;
+}
 
-    // Calculate difference in seconds and convert to days
-    double diff_seconds = difftime(current_time, lnmp_time);
-    if (diff_seconds < 0) {
-        snprintf(woa_out, woa_out_size, "LNMP is in the future");
-        return NAEGELES_ERR_FUTURE_DATE;
+/**
+ * Starts pool workers until there are at least the requested number; the pool lock must be
+ * held. A worker that fails to start is not retried now; callers also run queued tasks.
+ * @param workers Workers wanted.
+ */
+static void task_pool_grow(unsigned workers) {
+    while (task_pool.workers < workers) {
+        pthread_attr_t attr;
+        pthread_t tid;
+        if (pthread_attr_init(&attr) != 0) {
+            return;
+        }
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        const bool started = pthread_create(&tid, &attr, task_pool_worker, NULL) == 0;
+        pthread_attr_destroy(&attr);
+        if (!started) {
+            return;
+        }
+        task_pool.workers++;
+    }
+}
+
+/**
+ * Runs task(arg, 0) to task(arg, count - 1) concurrently and returns once all have finished.
+ * The calling thread runs the last task itself and then helps with any queued task, of this
+ * call or another, so the call completes even if no worker could be started.
+ *
+ * @param task Task body; called once per index, from any thread.
+ * @param arg Argument passed to every task.
+ * @param count Number of tasks; the pool grows to count - 1 workers (at most
+ * NAEGELES_MAX_THREADS - 1).
+ * @return NAEGELES_OK once every task has run, NAEGELES_ERR_NULL_PARAM if task is NULL.
+ */
+int naegeles_run_tasks(void (*task)(void* arg, unsigned index), void* arg, unsigned count) {
+    if (task == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+    if (count <= 1) {
+        if (count == 1) {
+            task(arg, 0);
+        }
+        return NAEGELES_OK;
     }
 
-    int total_days = (int)(diff_seconds / 86400);  // 86400 seconds per day
-    int weeks      = total_days / 7;
-    int days       = total_days % 7;
+    pool_job_t job = {task, arg, count - 1, 0, count - 1, NULL};
 
-    // Format the result conditionally
-    if (days > 0) {
-        snprintf(woa_out, woa_out_size, "%d %s, %d %s", weeks, weeks == 1 ? "week" : "weeks", days,
-                 days == 1 ? "day" : "days");
+    pthread_mutex_lock(&task_pool.lock);
+    task_pool_grow(count - 1 < NAEGELES_MAX_THREADS ? count - 1 : NAEGELES_MAX_THREADS - 1);
+    if (task_pool.tail != NULL) {
+        task_pool.tail->link = &job;
     } else {
-        snprintf(woa_out, woa_out_size, "%d %s", weeks, weeks == 1 ? "week" : "weeks");
+        task_pool.head = &job;
+    }
+    task_pool.tail = &job;
+    pthread_cond_broadcast(&task_pool.work);
+    pthread_mutex_unlock(&task_pool.lock);
+
+    task(arg, count - 1);
+
+    // Queued tasks of any call can be run here; this also covers workers that failed to start
+    pthread_mutex_lock(&task_pool.lock);
+    while (job.pending > 0) {
+        unsigned index   = 0;
+        pool_job_t* next = task_pool_take(&index);
+        if (next != NULL) {
+            task_pool_run(next, index);
+        } else {
+            pthread_cond_wait(&task_pool.done, &task_pool.lock);
+        }
     }
+    pthread_mutex_unlock(&task_pool.lock);
 
     return NAEGELES_OK;
 }
 
 /**
- * Computes both EDD and WOA in a single call.
- * This is a convenience function that calls both naegeles_compute_edd and naegeles_compute_woa.
+ * Resolves a requested thread count: 0 means one per online CPU, and the result is clamped to
+ * [1, NAEGELES_MAX_THREADS].
+ * @param threads Requested thread count.
+ * @return Thread count to use.
+ */
+unsigned naegeles_resolve_threads(unsigned threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads   = cpus > 0 ? (unsigned)cpus : 1;
+    }
+    return threads > NAEGELES_MAX_THREADS ? NAEGELES_MAX_THREADS : threads;
+}
+
+/** Smallest slice worth handing to a separate thread in naegeles_compute_batch_parallel. */
+#define PARALLEL_MIN_ROWS 16384
+
+/** One thread's share of a parallel batch. */
+typedef struct {
+    const naegeles_context_t* ctx;
+    const int32_t* lnmp;
+    size_t count;
+    naegeles_batch_t out;
+} batch_slice_t;
+
+/**
+ * naegeles_run_tasks body of naegeles_compute_batch_parallel: computes one slice.
+ * @param arg Array of slices.
+ * @param index Slice to compute.
+ */
+static void batch_slice_run(void* arg, unsigned index) {
+    const batch_slice_t* slice = (const batch_slice_t*)arg + index;
+    naegeles_compute_batch_ctx(slice->ctx, slice->lnmp, slice->count, &slice->out);
+}
+
+/**
+ * Computes EDD and WOA for an array of LNMP day numbers on several threads.
+ * The rows are split into contiguous slices, one per thread. Each thread writes only its own
+ * slice of the output arrays, so results stay in input order and no locking is needed.
+ * Batches under two PARALLEL_MIN_ROWS slices run on the calling thread; larger ones run on the
+ * worker pool through naegeles_run_tasks.
  *
- * @param lnmp Last Normal Menstrual Period in dd/mm/yyyy format.
- * @param edd_out Output buffer for EDD string. Must be at least DATE_STR_MAX_LEN bytes.
- * @param edd_out_size Size of the EDD output buffer.
- * @param woa_out Output buffer for WOA string. Must be at least WOA_STR_MAX_LEN bytes.
- * @param woa_out_size Size of the WOA output buffer.
- * @return NAEGELES_OK if both computations succeed, otherwise the first error encountered.
+ * @param ctx Context holding the reference date.
+ * @param lnmp Array of LNMP day numbers (days since 1970-01-01).
+ * @param count Number of rows in lnmp.
+ * @param out Output arrays, each with room for count elements.
+ * @param threads Number of threads; 0 uses one per online CPU.
+ * @return NAEGELES_OK if the batch was processed (check out->status per row), error code otherwise.
  */
-int naegeles_compute(const char* lnmp, char* edd_out, size_t edd_out_size, char* woa_out,
-                     size_t woa_out_size) {
-    int edd_result = naegeles_compute_edd(lnmp, edd_out, edd_out_size);
-    if (edd_result != NAEGELES_OK) {
-        return edd_result;
+int naegeles_compute_batch_parallel(const naegeles_context_t* ctx, const int32_t* lnmp,
+                                    size_t count, const naegeles_batch_t* out, unsigned threads) {
+    if (ctx == NULL || out == NULL || out->edd == NULL || out->woa_weeks == NULL ||
+        out->woa_days == NULL || out->status == NULL || (lnmp == NULL && count > 0)) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    threads = naegeles_resolve_threads(threads);
+    if (threads > count / PARALLEL_MIN_ROWS) {
+        threads = count / PARALLEL_MIN_ROWS > 0 ? (unsigned)(count / PARALLEL_MIN_ROWS) : 1;
+    }
+    if (threads == 1) {
+        return naegeles_compute_batch_ctx(ctx, lnmp, count, out);
+    }
+
+    batch_slice_t slices[NAEGELES_MAX_THREADS];
+    for (unsigned t = 0; t < threads; t++) {
+        size_t begin = count * t / threads;
+        size_t end   = count * (t + 1) / threads;
+        slices[t]    = (batch_slice_t){
+            .ctx   = ctx,
+            .lnmp  = lnmp + begin,
+            .count = end - begin,
+            .out   = {out->edd + begin, out->woa_weeks + begin, out->woa_days + begin,
+                      out->status + begin},
+        };
+    }
+
+    return naegeles_run_tasks(batch_slice_run, slices, threads);
+}
+
+#endif  // WASM_BUILD
+
+/**
+ * Takes a snapshot of the NAEGELES_STATS counters, summed over every live thread and every
+ * thread that has exited. Counters of other threads are read without stopping them, so a
+ * snapshot taken under load may be a few updates behind.
+ * @param out Snapshot to fill; all zero (with enabled == 0) when stats are not compiled in.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_stats_snapshot(naegeles_stats_t* out) {
+    if (out == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    *out = (naegeles_stats_t){0};
+
+#ifdef NAEGELES_STATS
+    uint64_t totals[STAT_COUNT] = {0};
+
+#ifdef WASM_BUILD
+    for (int i = 0; i < STAT_COUNT; i++) {
+        totals[i] = atomic_load_explicit(&stats_main.counters[i], memory_order_relaxed);
+    }
+#else
+    pthread_mutex_lock(&stats_lock);
+    for (int i = 0; i < STAT_COUNT; i++) {
+        totals[i] = stats_retired[i];
     }
+    for (const stats_block_t* block = stats_threads; block != NULL; block = block->next) {
+        for (int i = 0; i < STAT_COUNT; i++) {
+            totals[i] += atomic_load_explicit(&block->counters[i], memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+#endif
+
+    out->enabled          = 1;
+    out->ticks_are_cycles = STATS_TICKS_ARE_CYCLES;
+    out->calls            = totals[STAT_CALLS];
+    out->batch_calls      = totals[STAT_BATCH_CALLS];
+    out->batch_rows       = totals[STAT_BATCH_ROWS];
+    out->parse_rows       = totals[STAT_PARSE_ROWS];
+    for (int i = 0; i < NAEGELES_STAGE_COUNT; i++) {
+        out->stage_ticks[i] = totals[STAT_STAGE_TICKS + i];
+    }
+    for (int i = 0; i < NAEGELES_ERROR_CODES; i++) {
+        out->errors[i] = totals[STAT_ERRORS + i];
+    }
+    for (int i = 0; i < NAEGELES_LATENCY_BUCKETS; i++) {
+        out->latency[i] = totals[STAT_LATENCY + i];
+    }
+#endif
 
-    int woa_result = naegeles_compute_woa(lnmp, woa_out, woa_out_size);
-    return woa_result;
+    return NAEGELES_OK;
 }
 
 /**
@@ -277,40 +2388,11 @@ const char* naegeles_error_string(int error_code) {
             return "LNMP date is in the future";
         case NAEGELES_ERR_BUFFER_TOO_SMALL:
             return "Output buffer too small";
+        case NAEGELES_ERR_NO_MEMORY:
+            return "Memory allocation failed";
+        case NAEGELES_ERR_UNSUPPORTED:
+            return "Unsupported input type or value";
         default:
             return "Unknown error";
     }
 }
-
-// CLI-specific code - only compiled when not building for WASM
-#ifndef WASM_BUILD
-
-/**
- * Entry point for the CLI Naegele's rule EDD/WOA calculator.
- * @param argc Argument count.
- * @param argv Argument vector. Expects LNMP date in dd/mm/yyyy format.
- * @return 0 on success, 1 on error.
- */
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s LNMP[dd/mm/yyyy]\n", argv[0]);
-        return 1;
-    }
-
-    char edd[DATE_STR_MAX_LEN];
-    char woa[WOA_STR_MAX_LEN];
-
-    int result = naegeles_compute(argv[1], edd, sizeof(edd), woa, sizeof(woa));
-
-    if (result != NAEGELES_OK) {
-        fprintf(stderr, "Error: %s\n", naegeles_error_string(result));
-        return 1;
-    }
-
-    printf("EDD: %s\n", edd);
-    printf("WOA: %s\n", woa);
-
-    return 0;
-}
-
-#endif  // WASM_BUILD
@@ -0,0 +1,255 @@
+/**
+ * Naegele's rule library: estimated due date (EDD) and weeks of amenorrhea (WOA) from the last
+ * normal menstrual period (LNMP).
+ *
+ * Every function returns a naegeles_error_t code. Dates are dd/mm/yyyy strings or day numbers
+ * (days since 1970-01-01); LNMPs must fall in 1900-2100. The _layout parsers also accept the
+ * other record layouts of naegeles_date_layout_t. Build flags for edd.c:
+ *   NAEGELES_NO_SIMD   disable the vector batch kernel.
+ *   NAEGELES_EDD_LUT   look EDDs up in a precomputed table instead of computing them.
+ *   NAEGELES_STATS     collect call, stage, error and latency counters (naegeles_stats_snapshot).
+ *   WASM_BUILD         leave out the threaded API (naegeles_compute_batch_parallel and the
+ *                      worker pool behind it).
+ */
+#ifndef EDD_H
+#define EDD_H
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for int32_t, uint8_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length for date string in dd/mm/yyyy format. */
+#define DATE_STR_MAX_LEN 16
+
+/** Exact length of a date string in dd/mm/yyyy format, excluding the terminator. */
+#define DATE_STR_LEN 10
+
+/** Maximum length for WOA result string. */
+#define WOA_STR_MAX_LEN 32
+
+/** Upper bound on the threads used by naegeles_compute_batch_parallel. */
+#define NAEGELES_MAX_THREADS 256
+
+/** Return codes for API functions. */
+typedef enum {
+    NAEGELES_OK                   = 0,  /**< Operation successful. */
+    NAEGELES_ERR_NULL_PARAM       = -1, /**< NULL parameter provided. */
+    NAEGELES_ERR_INVALID_DATE     = -2, /**< Invalid date format or value. */
+    NAEGELES_ERR_DATE_CONVERSION  = -3, /**< Failed to convert date. */
+    NAEGELES_ERR_SYSTEM_TIME      = -4, /**< Failed to get system time. */
+    NAEGELES_ERR_FUTURE_DATE      = -5, /**< LNMP date is in the future. */
+    NAEGELES_ERR_BUFFER_TOO_SMALL = -6, /**< Output buffer too small. */
+    NAEGELES_ERR_NO_MEMORY        = -7, /**< Memory allocation failed. */
+    NAEGELES_ERR_UNSUPPORTED      = -8  /**< Unsupported input type or unrepresentable value. */
+} naegeles_error_t;
+
+/**
+ * Struct-of-arrays output buffers for naegeles_compute_batch.
+ * Dates are day numbers: days since 1970-01-01 (1970-01-01 is day 0).
+ * Every array must hold at least as many elements as the input batch.
+ */
+typedef struct {
+    int32_t* edd;       /**< EDD as a day number. */
+    int32_t* woa_weeks; /**< Completed weeks of amenorrhea. */
+    int32_t* woa_days;  /**< Remaining days after the completed weeks (0-6). */
+    int32_t* status;    /**< Per-row naegeles_error_t code. */
+} naegeles_batch_t;
+
+/**
+ * Structured EDD/WOA result, filled by naegeles_compute_result without any string formatting.
+ * On NAEGELES_ERR_FUTURE_DATE the EDD fields are still valid and the WOA fields are zero; on
+ * any other error every field except status is zero.
+ */
+typedef struct {
+    int edd_day;   /**< EDD day of month (1-31). */
+    int edd_month; /**< EDD month (1-12). */
+    int edd_year;  /**< EDD year. */
+    int woa_weeks; /**< Completed weeks of amenorrhea. */
+    int woa_days;  /**< Remaining days after the completed weeks (0-6). */
+    int status;    /**< naegeles_error_t code, same as the function's return value. */
+} naegeles_result_t;
+
+/**
+ * Reference date shared by a run of computations.
+ * Capture it once with naegeles_context_init (today) or naegeles_context_init_asof (any past
+ * date, e.g. to replay a historical report) and reuse it for every row of a batch.
+ */
+typedef struct {
+    int32_t as_of; /**< Reference date for WOA as a day number (days since 1970-01-01). */
+} naegeles_context_t;
+
+/** Date record layouts accepted by the _layout parsers. */
+typedef enum {
+    NAEGELES_LAYOUT_DMY_SLASH = 0, /**< dd/mm/yyyy, the layout of every other API. */
+    NAEGELES_LAYOUT_DMY_DASH  = 1, /**< dd-mm-yyyy. */
+    NAEGELES_LAYOUT_ISO       = 2, /**< yyyy-mm-dd (ISO 8601). */
+    NAEGELES_LAYOUT_COMPACT   = 3, /**< yyyymmdd. */
+    NAEGELES_LAYOUT_AUTO      = 4  /**< Detect from the (first) record. */
+} naegeles_date_layout_t;
+
+/**
+ * Dating methods for naegeles_compute_batch_methods. Each row has a date and a parameter whose
+ * meaning depends on its method; a parameter outside the listed range makes the row invalid.
+ * WOA is always counted from the LMP-equivalent start of gestation the method implies.
+ */
+typedef enum {
+    NAEGELES_METHOD_NAEGELE    = 0, /**< LNMP: +7 days, -3 months, +1 year. */
+    NAEGELES_METHOD_CYCLE      = 1, /**< LNMP, cycle length in days (21-45): Naegele + (p - 28). */
+    NAEGELES_METHOD_MITTENDORF = 2, /**< LNMP, prior births: +15 days (none) or +10, -3 months. */
+    NAEGELES_METHOD_CONCEPTION = 3, /**< Conception date: EDD 266 days later. */
+    NAEGELES_METHOD_IVF        = 4, /**< Transfer date, embryo age in days (2-7): 266 - p days. */
+    NAEGELES_METHOD_CRL        = 5, /**< Scan date, crown-rump length in mm (10-84), Robinson. */
+    NAEGELES_METHOD_BPD        = 6, /**< Scan date, biparietal diameter in mm (20-100), Hadlock. */
+    NAEGELES_METHOD_COUNT
+} naegeles_method_t;
+
+/** Result fields compared by naegeles_select_changed. */
+typedef enum {
+    NAEGELES_CHANGED_WEEKS = 0, /**< Status or completed weeks. */
+    NAEGELES_CHANGED_DAYS  = 1  /**< Status, completed weeks or remaining days. */
+} naegeles_change_t;
+
+/** Stages timed by NAEGELES_STATS; indexes naegeles_stats_t.stage_ticks. */
+typedef enum {
+    NAEGELES_STAGE_PARSE,  /**< Parsing and validating LNMP strings (single and batch). */
+    NAEGELES_STAGE_EDD,    /**< Applying Naegele's rule and converting back to a civil date. */
+    NAEGELES_STAGE_WOA,    /**< Weeks/days from the reference date. */
+    NAEGELES_STAGE_FORMAT, /**< Formatting EDD and WOA strings. */
+    NAEGELES_STAGE_BATCH,  /**< The batch kernel, per naegeles_compute_batch_ctx call. */
+    NAEGELES_STAGE_COUNT
+} naegeles_stage_t;
+
+/** Number of naegeles_error_t codes, NAEGELES_OK included. */
+#define NAEGELES_ERROR_CODES 9
+
+/** Buckets in the latency histogram; bucket b counts calls taking [2^b, 2^(b+1)) ticks. */
+#define NAEGELES_LATENCY_BUCKETS 32
+
+/**
+ * Counters merged from every thread by naegeles_stats_snapshot. Ticks are TSC cycles on x86
+ * and nanoseconds elsewhere. "Calls" are the string entry points (naegeles_compute*,
+ * including the _asof and _result variants), each counted once even when one calls another.
+ */
+typedef struct {
+    int enabled;                                 /**< 1 if built with NAEGELES_STATS. */
+    int ticks_are_cycles;                        /**< 1 for TSC cycles, 0 for nanoseconds. */
+    uint64_t calls;                              /**< String entry point calls. */
+    uint64_t batch_calls;                        /**< naegeles_compute_batch_ctx calls. */
+    uint64_t batch_rows;                         /**< Rows computed by the batch kernel. */
+    uint64_t parse_rows;                         /**< Records parsed, batch and single-record. */
+    uint64_t stage_ticks[NAEGELES_STAGE_COUNT];  /**< Time spent per naegeles_stage_t. */
+    uint64_t errors[NAEGELES_ERROR_CODES];       /**< Per code (index -code): calls + batch rows. */
+    uint64_t latency[NAEGELES_LATENCY_BUCKETS];  /**< String entry point call durations. */
+} naegeles_stats_t;
+
+/** Computes the EDD and WOA at as_of as numbers, without formatting. */
+int naegeles_compute_result_asof(const char* lnmp, int32_t as_of, naegeles_result_t* out);
+
+/** Computes the EDD and WOA at today's date as numbers, without formatting. */
+int naegeles_compute_result(const char* lnmp, naegeles_result_t* out);
+
+/** Formats the EDD of an LNMP as dd/mm/yyyy. */
+int naegeles_compute_edd(const char* lnmp, char* edd_out, size_t edd_out_size);
+
+/** Formats the WOA of an LNMP at as_of as "N weeks, M days". */
+int naegeles_compute_woa_asof(const char* lnmp, int32_t as_of, char* woa_out,
+                              size_t woa_out_size);
+
+/** Formats the WOA of an LNMP at today's date. */
+int naegeles_compute_woa(const char* lnmp, char* woa_out, size_t woa_out_size);
+
+/** Formats both the EDD and the WOA at as_of from a single parse. */
+int naegeles_compute_asof(const char* lnmp, int32_t as_of, char* edd_out, size_t edd_out_size,
+                          char* woa_out, size_t woa_out_size);
+
+/** Formats both the EDD and the WOA at today's date from a single parse. */
+int naegeles_compute(const char* lnmp, char* edd_out, size_t edd_out_size, char* woa_out,
+                     size_t woa_out_size);
+
+/** Initializes a context with today's local date as the reference date. */
+int naegeles_context_init(naegeles_context_t* ctx);
+
+/** Initializes a context with an explicit reference date. */
+int naegeles_context_init_asof(naegeles_context_t* ctx, int32_t as_of);
+
+/** Converts a civil date (1900-2100) to a day number. */
+int naegeles_date_to_days(int day, int month, int year, int32_t* days_out);
+
+/** Converts a day number to a civil date. */
+int naegeles_days_to_date(int32_t days, int* day, int* month, int* year);
+
+/** Writes a day number as dd/mm/yyyy (no NUL); returns the length or an error code. */
+int naegeles_format_date(int32_t days, char* out, size_t out_size);
+
+/** Writes "N weeks[, M days]" (no NUL); returns the length or an error code. */
+int naegeles_format_woa(int32_t weeks, int32_t days, char* out, size_t out_size);
+
+/** Writes an unsigned decimal integer (no NUL); returns the length or an error code. */
+int naegeles_format_uint(uint32_t value, char* out, size_t out_size);
+
+/** Parses a NUL-terminated dd/mm/yyyy string into a day number. */
+int naegeles_parse_date(const char* lnmp, int32_t* days_out);
+
+/** Parses count fixed-width dd/mm/yyyy records, stride bytes apart, into day numbers. */
+int naegeles_parse_batch(const char* records, size_t stride, size_t count, int32_t* days_out,
+                         int32_t* status);
+
+/** Returns the naegeles_date_layout_t of a len-byte date record, or an error code. */
+int naegeles_detect_layout(const char* text, size_t len);
+
+/** Parses a len-byte date in the given layout (or detected, for AUTO) into a day number. */
+int naegeles_parse_date_layout(const char* text, size_t len, naegeles_date_layout_t layout,
+                               int32_t* days_out);
+
+/** Like naegeles_parse_batch for any layout; AUTO detects it from the first record. */
+int naegeles_parse_batch_layout(const char* records, size_t stride, size_t count,
+                                naegeles_date_layout_t layout, int32_t* days_out,
+                                int32_t* status);
+
+/** Computes EDD and WOA for an array of LNMP day numbers against the context's date. */
+int naegeles_compute_batch_ctx(const naegeles_context_t* ctx, const int32_t* lnmp, size_t count,
+                               const naegeles_batch_t* out);
+
+/** Like naegeles_compute_batch_ctx, computing each distinct LNMP of a clustered batch once. */
+int naegeles_compute_batch_dedup(const naegeles_context_t* ctx, const int32_t* lnmp,
+                                 size_t count, const naegeles_batch_t* out);
+
+/** Like naegeles_compute_batch_ctx with a naegeles_method_t and parameter per row. */
+int naegeles_compute_batch_methods(const naegeles_context_t* ctx, const int32_t* date,
+                                   const uint8_t* method, const uint8_t* param, size_t count,
+                                   const naegeles_batch_t* out);
+
+/** Computes EDD and WOA for an array of LNMP day numbers against today's date. */
+int naegeles_compute_batch(const int32_t* lnmp, size_t count, const naegeles_batch_t* out);
+
+/** Lists the rows whose batch result at ctx differs from the one at prev_as_of (no outputs). */
+int naegeles_select_changed(const naegeles_context_t* ctx, int32_t prev_as_of,
+                            const int32_t* lnmp, size_t count, naegeles_change_t change,
+                            size_t* rows_out, size_t* changed_out);
+
+#ifndef WASM_BUILD
+/** Like naegeles_compute_batch_ctx, split across threads (0 uses one per online CPU). */
+int naegeles_compute_batch_parallel(const naegeles_context_t* ctx, const int32_t* lnmp,
+                                    size_t count, const naegeles_batch_t* out, unsigned threads);
+
+/** Runs task(arg, i) for each i below count on the shared worker pool and waits for them. */
+int naegeles_run_tasks(void (*task)(void* arg, unsigned index), void* arg, unsigned count);
+
+/** Resolves a thread count: 0 means one per online CPU; clamped to [1, NAEGELES_MAX_THREADS]. */
+unsigned naegeles_resolve_threads(unsigned threads);
+#endif
+
+/** Fills out with counters merged from every thread; all zero unless built with NAEGELES_STATS. */
+int naegeles_stats_snapshot(naegeles_stats_t* out);
+
+/** Returns a human-readable message for an error code (never NULL). */
+const char* naegeles_error_string(int error_code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // EDD_H
@@ -0,0 +1,212 @@
+/**
+ * Header-only C++17 layer over the Naegele's rule arithmetic in edd.c.
+ *
+ * Everything here is constexpr and inline, so calls fold to constants when their inputs are
+ * known and inline into callers' loops otherwise; nothing needs to be linked. The rules and
+ * limits are the same as the C library (LNMP 1900-2100, EDD rolls over past short months), and
+ * error codes are the naegeles_error_t values from edd.h.
+ */
+#ifndef EDD_HPP
+#define EDD_HPP
+
+#include <cstdint>      // for int32_t, int64_t
+#include <string_view>  // for std::string_view
+
+#include "edd.h"
+
+namespace naegeles {
+
+/** Earliest valid LNMP year. */
+inline constexpr int min_year = 1900;
+
+/** Latest valid LNMP year. */
+inline constexpr int max_year = 2100;
+
+/** Days added to the LNMP before shifting the month. */
+inline constexpr int edd_day_offset = 7;
+
+/** Months subtracted (or 12 minus this added) for the EDD. */
+inline constexpr int edd_month_offset = 3;
+
+/** A civil date. */
+struct date {
+    int day;   /**< Day of month (1-31). */
+    int month; /**< Month (1-12). */
+    int year;  /**< Year. */
+
+    constexpr bool operator==(const date& other) const {
+        return day == other.day && month == other.month && year == other.year;
+    }
+    constexpr bool operator!=(const date& other) const { return !(*this == other); }
+};
+
+/** Weeks of amenorrhea. */
+struct woa {
+    int weeks; /**< Completed weeks. */
+    int days;  /**< Remaining days after the completed weeks (0-6). */
+};
+
+/** A day number, or the error that prevented computing it. */
+struct day_result {
+    int32_t days;            /**< Day number (days since 1970-01-01); 0 on error. */
+    naegeles_error_t status; /**< NAEGELES_OK or the error code. */
+};
+
+/** A WOA, or the error that prevented computing it. */
+struct woa_result {
+    woa value;               /**< WOA; zero on error. */
+    naegeles_error_t status; /**< NAEGELES_OK or the error code. */
+};
+
+/** Returns true if year is a Gregorian leap year. */
+constexpr bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+/** Returns the length of a month (1-12), or 0 for an invalid month. */
+constexpr int days_in_month(int month, int year) {
+    constexpr int lengths[13] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12) {
+        return 0;
+    }
+    return month == 2 && is_leap_year(year) ? 29 : lengths[month];
+}
+
+/** Returns true if d is a real date inside the supported LNMP range. */
+constexpr bool is_valid_date(date d) {
+    return d.year >= min_year && d.year <= max_year && d.day >= 1 &&
+           d.day <= days_in_month(d.month, d.year);
+}
+
+/**
+ * Converts a civil date to a day number (days since 1970-01-01).
+ * The day may exceed the month length; the excess rolls over into the following month.
+ */
+constexpr int32_t days_from_civil(date d) {
+    const int year = d.year - (d.month <= 2);
+    const int era  = (year >= 0 ? year : year - 399) / 400;
+    const int yoe  = year - era * 400;                                       // [0, 399]
+    const int doy  = (153 * (d.month > 2 ? d.month - 3 : d.month + 9) + 2) / 5 + d.day - 1;
+    const int doe  = yoe * 365 + yoe / 4 - yoe / 100 + doy;                  // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+/** Converts a day number (days since 1970-01-01) to a civil date. */
+constexpr date civil_from_days(int32_t days) {
+    days += 719468;
+    const int era   = (days >= 0 ? days : days - 146096) / 146097;
+    const int doe   = days - era * 146097;                                   // [0, 146096]
+    const int yoe   = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    const int doy   = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365]
+    const int mp    = (5 * doy + 2) / 153;                                   // [0, 11]
+    const int month = mp < 10 ? mp + 3 : mp - 9;
+    return date{doy - (153 * mp + 2) / 5 + 1, month, yoe + era * 400 + (month <= 2)};
+}
+
+/** Day number of 1900-01-01, the earliest valid LNMP. */
+inline constexpr int32_t min_day_number = days_from_civil(date{1, 1, min_year});
+
+/** Day number of 2100-12-31, the latest valid LNMP. */
+inline constexpr int32_t max_day_number = days_from_civil(date{31, 12, max_year});
+
+/** Returns true if days is a valid LNMP day number. */
+constexpr bool is_valid_day_number(int32_t days) {
+    return days >= min_day_number && days <= max_day_number;
+}
+
+/**
+ * Applies Naegele's rule to a valid LNMP day number: add 7 days, then subtract 3 months and add
+ * a year (or add 9 months), rolling over past short months as edd.c does.
+ */
+constexpr int32_t edd_days(int32_t lnmp_days) {
+    date d = civil_from_days(lnmp_days + edd_day_offset);
+    if (d.month > edd_month_offset) {
+        d.month -= edd_month_offset;
+        d.year += 1;
+    } else {
+        d.month += 12 - edd_month_offset;
+    }
+    return days_from_civil(d);
+}
+
+/** Returns the EDD of a valid LNMP. */
+constexpr date edd(date lnmp) {
+    return civil_from_days(edd_days(days_from_civil(lnmp)));
+}
+
+/** Computes the WOA of an LNMP day number at a reference day number (any int32). */
+constexpr woa_result woa_at(int32_t lnmp_days, int32_t as_of) {
+    if (!is_valid_day_number(lnmp_days)) {
+        return {{0, 0}, NAEGELES_ERR_INVALID_DATE};
+    }
+    const int64_t total = int64_t{as_of} - lnmp_days;
+    if (total < 0) {
+        return {{0, 0}, NAEGELES_ERR_FUTURE_DATE};
+    }
+    return {{static_cast<int>(total / 7), static_cast<int>(total % 7)}, NAEGELES_OK};
+}
+
+/** Parses an exact dd/mm/yyyy string into a valid LNMP day number. */
+constexpr day_result parse_date(std::string_view text) {
+    if (text.size() != DATE_STR_LEN || text[2] != '/' || text[5] != '/') {
+        return {0, NAEGELES_ERR_INVALID_DATE};
+    }
+
+    constexpr int starts[3] = {0, 3, 6};
+    constexpr int widths[3] = {2, 2, 4};
+    int fields[3]           = {0, 0, 0};
+    for (int f = 0; f < 3; f++) {
+        for (int i = starts[f]; i < starts[f] + widths[f]; i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                return {0, NAEGELES_ERR_INVALID_DATE};
+            }
+            fields[f] = fields[f] * 10 + (text[i] - '0');
+        }
+    }
+
+    const date d{fields[0], fields[1], fields[2]};
+    if (!is_valid_date(d)) {
+        return {0, NAEGELES_ERR_INVALID_DATE};
+    }
+    return {days_from_civil(d), NAEGELES_OK};
+}
+
+/** Computes the EDD day number of a dd/mm/yyyy LNMP. */
+constexpr day_result edd_days(std::string_view lnmp) {
+    const day_result parsed = parse_date(lnmp);
+    if (parsed.status != NAEGELES_OK) {
+        return parsed;
+    }
+    return {edd_days(parsed.days), NAEGELES_OK};
+}
+
+/** Writes a date as dd/mm/yyyy into out, which must have room for DATE_STR_LEN chars. */
+constexpr void format_date(date d, char* out) {
+    out[0] = static_cast<char>('0' + d.day / 10);
+    out[1] = static_cast<char>('0' + d.day % 10);
+    out[2] = '/';
+    out[3] = static_cast<char>('0' + d.month / 10);
+    out[4] = static_cast<char>('0' + d.month % 10);
+    out[5] = '/';
+    out[6] = static_cast<char>('0' + d.year / 1000);
+    out[7] = static_cast<char>('0' + d.year / 100 % 10);
+    out[8] = static_cast<char>('0' + d.year / 10 % 10);
+    out[9] = static_cast<char>('0' + d.year % 10);
+}
+
+// Same anchors as the C library's static asserts and examples
+static_assert(min_day_number == -25567, "1900-01-01 must be day -25567");
+static_assert(max_day_number == 47846, "2100-12-31 must be day 47846");
+static_assert(civil_from_days(0) == date{1, 1, 1970}, "day 0 must be 1970-01-01");
+static_assert(edd(date{1, 1, 2024}) == date{8, 10, 2024}, "EDD of 01/01/2024");
+static_assert(edd(date{29, 2, 2024}) == date{7, 12, 2024}, "EDD of a leap day");
+static_assert(edd(date{24, 12, 2023}) == date{1, 10, 2024}, "31/09 rolls over to 01/10");
+static_assert(parse_date("31/02/2024").status == NAEGELES_ERR_INVALID_DATE, "no 31 February");
+static_assert(parse_date("1/1/2024").status == NAEGELES_ERR_INVALID_DATE, "exact layout only");
+static_assert(woa_at(parse_date("12/03/2024").days, parse_date("01/06/2024").days).value.weeks ==
+                  11,
+              "WOA weeks");
+
+}  // namespace naegeles
+
+#endif  // EDD_HPP
@@ -0,0 +1,270 @@
+/**
+ * Arrow C Data Interface import and export around naegeles_compute_batch_ctx; see edd_arrow.h.
+ */
+#define _POSIX_C_SOURCE 200809L  // for posix_memalign
+
+#include "edd_arrow.h"
+
+#include <stdatomic.h>  // for atomic_int, atomic_init, atomic_fetch_sub
+#include <stdbool.h>    // for bool, true, false
+#include <stddef.h>     // for size_t
+#include <stdint.h>     // for int8_t, int16_t, int32_t, int64_t, uint8_t, INT16_MAX
+#include <stdlib.h>     // for posix_memalign, free
+#include <string.h>     // for memset, strcmp
+
+/** Children of the exported struct array, in column order. */
+enum { CHILD_EDD, CHILD_WOA_WEEKS, CHILD_WOA_DAYS, CHILD_STATUS, CHILD_COUNT };
+
+/** Rows per kernel call; the int32 WOA and status outputs are narrowed from a stack chunk. */
+#define ARROW_CHUNK_ROWS 1024
+
+/** Buffer alignment recommended by the Arrow columnar format. */
+#define ARROW_ALIGNMENT 64
+
+/**
+ * One allocation behind an exported array and its children. Children can be moved out and
+ * released on their own, so the block is freed by whichever release drops the last reference.
+ */
+typedef struct {
+    atomic_int refs;
+    struct ArrowArray children[CHILD_COUNT];
+    struct ArrowArray* child_ptrs[CHILD_COUNT];
+    const void* struct_buffers[1];             /**< Struct validity. */
+    const void* child_buffers[CHILD_COUNT][2]; /**< Validity and values per child. */
+} arrow_array_block_t;
+
+/** One allocation behind an exported schema and its children, shared the same way. */
+typedef struct {
+    atomic_int refs;
+    struct ArrowSchema children[CHILD_COUNT];
+    struct ArrowSchema* child_ptrs[CHILD_COUNT];
+} arrow_schema_block_t;
+
+/** Column names and formats of the exported struct children. */
+static const char* const child_names[CHILD_COUNT]   = {"edd", "woa_weeks", "woa_days", "status"};
+static const char* const child_formats[CHILD_COUNT] = {"tdD", "s", "s", "c"};
+
+/**
+ * Release callback for the exported array and each of its children.
+ * @param array Array to release.
+ */
+static void release_array(struct ArrowArray* array) {
+    arrow_array_block_t* block = array->private_data;
+
+    // Children still in place are released with the parent; moved ones have release == NULL
+    for (int64_t i = 0; i < array->n_children; i++) {
+        if (array->children[i]->release != NULL) {
+            array->children[i]->release(array->children[i]);
+        }
+    }
+
+    array->release = NULL;
+    if (atomic_fetch_sub(&block->refs, 1) == 1) {
+        free(block);
+    }
+}
+
+/**
+ * Release callback for the exported schema and each of its children.
+ * @param schema Schema to release.
+ */
+static void release_schema(struct ArrowSchema* schema) {
+    arrow_schema_block_t* block = schema->private_data;
+
+    for (int64_t i = 0; i < schema->n_children; i++) {
+        if (schema->children[i]->release != NULL) {
+            schema->children[i]->release(schema->children[i]);
+        }
+    }
+
+    schema->release = NULL;
+    if (atomic_fetch_sub(&block->refs, 1) == 1) {
+        free(block);
+    }
+}
+
+/**
+ * Exports the result schema: a struct of edd (date32), woa_weeks, woa_days (int16) and status
+ * (int8), all nullable.
+ * @param out Schema to fill.
+ * @return false if allocation failed.
+ */
+static bool export_schema(struct ArrowSchema* out) {
+    arrow_schema_block_t* block = malloc(sizeof(*block));
+    if (block == NULL) {
+        return false;
+    }
+    atomic_init(&block->refs, 1 + CHILD_COUNT);
+
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        block->children[i] = (struct ArrowSchema){
+            .format       = child_formats[i],
+            .name         = child_names[i],
+            .flags        = ARROW_FLAG_NULLABLE,
+            .release      = release_schema,
+            .private_data = block,
+        };
+        block->child_ptrs[i] = &block->children[i];
+    }
+
+    *out = (struct ArrowSchema){
+        .format       = "+s",
+        .name         = "",
+        .flags        = ARROW_FLAG_NULLABLE,
+        .n_children   = CHILD_COUNT,
+        .children     = block->child_ptrs,
+        .release      = release_schema,
+        .private_data = block,
+    };
+    return true;
+}
+
+/**
+ * Rounds a buffer size up to ARROW_ALIGNMENT.
+ * @param size Size in bytes.
+ * @return Aligned size.
+ */
+static size_t align_up(size_t size) {
+    return (size + ARROW_ALIGNMENT - 1) & ~(size_t)(ARROW_ALIGNMENT - 1);
+}
+
+/**
+ * Tests bit i of an Arrow validity bitmap (least significant bit first).
+ * @param bitmap Bitmap bytes.
+ * @param i Bit index.
+ */
+static inline bool bitmap_get(const uint8_t* bitmap, int64_t i) {
+    return bitmap[i >> 3] >> (i & 7) & 1;
+}
+
+/**
+ * Sets bit i of an Arrow validity bitmap.
+ * @param bitmap Bitmap bytes.
+ * @param i Bit index.
+ */
+static inline void bitmap_set(uint8_t* bitmap, int64_t i) {
+    bitmap[i >> 3] |= (uint8_t)(1u << (i & 7));
+}
+
+/**
+ * Computes EDD and WOA for a date32 array; see edd_arrow.h.
+ * @param ctx Reference date.
+ * @param lnmp_schema Schema of the input; must be date32 ("tdD").
+ * @param lnmp Input array.
+ * @param out_schema Output schema to fill.
+ * @param out Output array to fill.
+ * @return NAEGELES_OK on success, error code otherwise.
+ */
+int naegeles_arrow_compute(const naegeles_context_t* ctx, const struct ArrowSchema* lnmp_schema,
+                           const struct ArrowArray* lnmp, struct ArrowSchema* out_schema,
+                           struct ArrowArray* out) {
+    if (ctx == NULL || lnmp_schema == NULL || lnmp == NULL || out_schema == NULL || out == NULL ||
+        lnmp_schema->format == NULL || lnmp->release == NULL) {
+        return NAEGELES_ERR_NULL_PARAM;
+    }
+
+    if (strcmp(lnmp_schema->format, "tdD") != 0 || lnmp->n_buffers != 2 || lnmp->length < 0 ||
+        lnmp->offset < 0 || (lnmp->length > 0 && lnmp->buffers[1] == NULL)) {
+        return NAEGELES_ERR_UNSUPPORTED;
+    }
+
+    const int64_t rows  = lnmp->length;
+    const size_t n      = (size_t)rows;
+    const size_t bitmap = align_up((n + 7) / 8);
+    const size_t header = align_up(sizeof(arrow_array_block_t));
+    const size_t total  = header + 5 * bitmap + align_up(n * sizeof(int32_t)) +
+                           2 * align_up(n * sizeof(int16_t)) + align_up(n * sizeof(int8_t));
+
+    void* memory = NULL;
+    if (posix_memalign(&memory, ARROW_ALIGNMENT, total) != 0) {
+        return NAEGELES_ERR_NO_MEMORY;
+    }
+    if (!export_schema(out_schema)) {
+        free(memory);
+        return NAEGELES_ERR_NO_MEMORY;
+    }
+
+    // Carve the buffers out of the block; bitmaps start cleared
+    arrow_array_block_t* block = memory;
+    uint8_t* next              = (uint8_t*)memory + header;
+    uint8_t* valid[1 + CHILD_COUNT];
+    for (int i = 0; i < 1 + CHILD_COUNT; i++) {
+        valid[i] = next;
+        next += bitmap;
+    }
+    memset(valid[0], 0, 5 * bitmap);
+    int32_t* edd = (int32_t*)next;
+    next += align_up(n * sizeof(int32_t));
+    int16_t* woa_weeks = (int16_t*)next;
+    next += align_up(n * sizeof(int16_t));
+    int16_t* woa_days = (int16_t*)next;
+    next += align_up(n * sizeof(int16_t));
+    int8_t* status = (int8_t*)next;
+
+    // The input values are day numbers already, so the kernel reads them in place
+    const int32_t* days            = (const int32_t*)lnmp->buffers[1] + lnmp->offset;
+    const uint8_t* in_valid        = lnmp->null_count != 0 ? lnmp->buffers[0] : NULL;
+    int64_t nulls[1 + CHILD_COUNT] = {0};
+
+    for (size_t start = 0; start < n; start += ARROW_CHUNK_ROWS) {
+        const size_t count = n - start < ARROW_CHUNK_ROWS ? n - start : ARROW_CHUNK_ROWS;
+        int32_t weeks32[ARROW_CHUNK_ROWS], days32[ARROW_CHUNK_ROWS], status32[ARROW_CHUNK_ROWS];
+        const naegeles_batch_t batch = {edd + start, weeks32, days32, status32};
+        naegeles_compute_batch_ctx(ctx, days + start, count, &batch);
+
+        for (size_t i = 0; i < count; i++) {
+            const int64_t row  = (int64_t)(start + i);
+            const bool present = in_valid == NULL || bitmap_get(in_valid, lnmp->offset + row);
+            int32_t code       = status32[i];
+            if (code == NAEGELES_OK && weeks32[i] > INT16_MAX) {
+                code = NAEGELES_ERR_UNSUPPORTED;
+            }
+
+            const bool has_edd =
+                present && (code == NAEGELES_OK || code == NAEGELES_ERR_FUTURE_DATE);
+            const bool has_woa = present && code == NAEGELES_OK;
+            edd[row]           = has_edd ? edd[row] : 0;
+            woa_weeks[row]     = has_woa ? (int16_t)weeks32[i] : 0;
+            woa_days[row]      = has_woa ? (int16_t)days32[i] : 0;
+            status[row]        = present ? (int8_t)code : 0;
+
+            const bool child_valid[1 + CHILD_COUNT] = {present, has_edd, has_woa, has_woa, present};
+            for (int c = 0; c < 1 + CHILD_COUNT; c++) {
+                if (child_valid[c]) {
+                    bitmap_set(valid[c], row);
+                } else {
+                    nulls[c]++;
+                }
+            }
+        }
+    }
+
+    atomic_init(&block->refs, 1 + CHILD_COUNT);
+    const void* values[CHILD_COUNT] = {edd, woa_weeks, woa_days, status};
+    for (int c = 0; c < CHILD_COUNT; c++) {
+        block->child_buffers[c][0] = valid[1 + c];
+        block->child_buffers[c][1] = values[c];
+        block->children[c]         = (struct ArrowArray){
+            .length       = rows,
+            .null_count   = nulls[1 + c],
+            .n_buffers    = 2,
+            .buffers      = block->child_buffers[c],
+            .release      = release_array,
+            .private_data = block,
+        };
+        block->child_ptrs[c] = &block->children[c];
+    }
+    block->struct_buffers[0] = valid[0];
+
+    *out = (struct ArrowArray){
+        .length       = rows,
+        .null_count   = nulls[0],
+        .n_buffers    = 1,
+        .n_children   = CHILD_COUNT,
+        .buffers      = block->struct_buffers,
+        .children     = block->child_ptrs,
+        .release      = release_array,
+        .private_data = block,
+    };
+    return NAEGELES_OK;
+}
@@ -0,0 +1,88 @@
+/**
+ * Arrow C Data Interface bindings for the batch kernel (edd_arrow.c), so columnar data never
+ * goes through text.
+ *
+ * The input is an Arrow date32 array ("tdD"): day numbers since 1970-01-01, the same
+ * representation as the batch API, so its values buffer is passed to the kernel in place. The
+ * output is a struct array ("+s") with one row per input row:
+ *
+ *   edd        date32  EDD; null unless status is NAEGELES_OK or NAEGELES_ERR_FUTURE_DATE
+ *   woa_weeks  int16   completed weeks; null unless status is NAEGELES_OK
+ *   woa_days   int16   remaining days (0-6); null unless status is NAEGELES_OK
+ *   status     int8    naegeles_error_t code; null for null LNMPs
+ *
+ * A null LNMP gives a null struct row. The kernel writes EDDs straight into the exported edd
+ * buffer; WOA and status are narrowed from the kernel's int32 outputs chunk by chunk. WOAs
+ * over INT16_MAX weeks do not fit the int16 column and are reported as NAEGELES_ERR_UNSUPPORTED.
+ */
+#ifndef EDD_ARROW_H
+#define EDD_ARROW_H
+
+#include <stdint.h>  // for int64_t
+
+#include "edd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Structure definitions from the Arrow C Data Interface specification; the guard lets them
+// coexist with Arrow's own headers.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+/**
+ * Computes EDD and WOA for every row of a date32 LNMP array and exports the result as a
+ * struct array, described above. The input is only read and stays owned by the caller; the
+ * caller owns the outputs and must call their release callbacks.
+ * @return NAEGELES_OK, NAEGELES_ERR_NULL_PARAM, NAEGELES_ERR_UNSUPPORTED if the input is not a
+ * date32 array, or NAEGELES_ERR_NO_MEMORY if the output could not be allocated.
+ */
+int naegeles_arrow_compute(const naegeles_context_t* ctx, const struct ArrowSchema* lnmp_schema,
+                           const struct ArrowArray* lnmp, struct ArrowSchema* out_schema,
+                           struct ArrowArray* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // EDD_ARROW_H
@@ -0,0 +1,991 @@
+/**
+ * Command-line front end for the Naegele's rule library (edd.c): a single LNMP, streaming
+ * mode for bulk files and stdin, or a long-running binary-protocol server (edd_server.c).
+ */
+#define _POSIX_C_SOURCE 200809L  // for fileno, mmap
+
+#include "edd.h"
+#include "edd_server.h"
+
+#include <stdbool.h>   // for bool, true, false
+#include <stddef.h>    // for size_t
+#include <stdint.h>    // for int32_t, uint32_t, UINT32_MAX
+#include <stdio.h>     // for printf, fprintf, fopen, fread, fwrite
+#include <stdlib.h>    // for malloc, calloc, realloc, free, strtoul
+#include <string.h>    // for memchr, memcpy, memmove, strcmp, strlen
+#include <sys/mman.h>  // for mmap, munmap, posix_madvise
+#include <sys/stat.h>  // for fstat, struct stat, S_ISREG
+
+/** Size of the streaming read buffer. */
+#define STREAM_BUF_SIZE (1 << 20)
+
+/** Size of the preallocated output buffer, flushed in whole blocks. */
+#define STREAM_OUT_BUF_SIZE (4 << 20)
+
+/** Rows handed to the batch kernel at a time in streaming mode. */
+#define STREAM_BATCH_ROWS 4096
+
+/** Input bytes each worker processes per round in parallel streaming mode. */
+#define STREAM_SEGMENT_SIZE (4 << 20)
+
+/** Bytes of an overlong input line echoed back in its error row. */
+#define STREAM_OVERLONG_FIELD 16
+
+/**
+ * Buffered writer that emits output in large blocks instead of per-row stdio calls.
+ * A writer with no file collects its output in memory, growing as needed.
+ */
+typedef struct {
+    FILE* file;  /**< Destination stream, or NULL to buffer in memory. */
+    char* buf;   /**< Pending output. */
+    size_t len;  /**< Bytes pending in buf. */
+    size_t cap;  /**< Capacity of buf. */
+    bool failed; /**< Set once a write to file fails. */
+} writer_t;
+
+/** Options for streaming mode. */
+typedef struct {
+    char delim;                    /**< Output field separator (',' or '\t'). */
+    char in_delim;                 /**< Input field separator used with column. */
+    size_t column;                 /**< 1-based input column holding the LNMP; 0 uses the line. */
+    bool header;                   /**< Skip the first input line. */
+    unsigned threads;              /**< Worker threads (1 processes inline). */
+    naegeles_date_layout_t layout; /**< LNMP layout; AUTO is resolved from the first record. */
+    naegeles_context_t ctx;        /**< Reference date shared by every row. */
+    bool incremental;              /**< Only write rows whose result changed since since. */
+    int32_t since;                 /**< Previous run's reference date, with incremental. */
+    naegeles_change_t change;      /**< Fields compared with incremental. */
+} stream_options_t;
+
+/**
+ * Writes all pending output to the destination stream.
+ * @param w Writer.
+ * @return true on success, false if the write failed.
+ */
+static bool writer_flush(writer_t* w) {
+    if (w->len > 0 && !w->failed && fwrite(w->buf, 1, w->len, w->file) != w->len) {
+        w->failed = true;
+    }
+    w->len = 0;
+    return !w->failed;
+}
+
+/**
+ * Ensures at least n bytes can be appended without overflowing the buffer.
+ * @param w Writer.
+ * @param n Number of bytes about to be appended (at most the initial capacity).
+ * @return Pointer to the first free byte.
+ */
+static inline char* writer_reserve(writer_t* w, size_t n) {
+    if (w->cap - w->len < n) {
+        if (w->file != NULL) {
+            writer_flush(w);
+        } else {
+            char* grown = realloc(w->buf, w->cap * 2);
+            if (grown != NULL) {
+                w->buf = grown;
+                w->cap *= 2;
+            } else {
+                w->failed = true;  // Drop pending output rather than overflow
+                w->len    = 0;
+            }
+        }
+    }
+    return w->buf + w->len;
+}
+
+/**
+ * Appends raw bytes.
+ * @param w Writer.
+ * @param data Bytes to append.
+ * @param n Number of bytes (at most w->cap).
+ */
+static inline void writer_put(writer_t* w, const char* data, size_t n) {
+    memcpy(writer_reserve(w, n), data, n);
+    w->len += n;
+}
+
+/**
+ * Appends a block of any size, writing it straight through when it does not fit the buffer.
+ * @param w Writer backed by a file.
+ * @param data Bytes to append.
+ * @param n Number of bytes.
+ */
+static void writer_put_block(writer_t* w, const char* data, size_t n) {
+    if (w->cap - w->len >= n) {
+        writer_put(w, data, n);
+        return;
+    }
+
+    writer_flush(w);
+    if (!w->failed && fwrite(data, 1, n, w->file) != n) {
+        w->failed = true;
+    }
+}
+
+/**
+ * Appends a non-negative integer in decimal.
+ * @param w Writer.
+ * @param value Value to append.
+ */
+static inline void writer_put_uint(writer_t* w, unsigned value) {
+    w->len += (size_t)naegeles_format_uint(value, writer_reserve(w, 10), 10);
+}
+
+/**
+ * Appends a row number in decimal.
+ * @param w Writer.
+ * @param value Value to append.
+ */
+static void writer_put_size(writer_t* w, size_t value) {
+    if (value > UINT32_MAX) {
+        // Split off the low nine digits, zero-padded
+        writer_put_size(w, value / 1000000000);
+        char* out = writer_reserve(w, 9);
+        value %= 1000000000;
+        for (int i = 8; i >= 0; i--) {
+            out[i] = (char)('0' + value % 10);
+            value /= 10;
+        }
+        w->len += 9;
+        return;
+    }
+    writer_put_uint(w, (unsigned)value);
+}
+
+/**
+ * Appends a day number as dd/mm/yyyy.
+ * @param w Writer.
+ * @param days Day number inside the table range.
+ */
+static inline void writer_put_date(writer_t* w, int32_t days) {
+    w->len += (size_t)naegeles_format_date(days, writer_reserve(w, DATE_STR_LEN), DATE_STR_LEN);
+}
+
+/**
+ * Appends an input field, quoting it if it contains the separator, a quote or a carriage return.
+ * @param w Writer.
+ * @param field Field bytes.
+ * @param n Field length.
+ * @param delim Output field separator.
+ */
+static void writer_put_field(writer_t* w, const char* field, size_t n, char delim) {
+    bool needs_quotes = false;
+    for (size_t i = 0; i < n && !needs_quotes; i++) {
+        needs_quotes = field[i] == delim || field[i] == '"' || field[i] == '\r';
+    }
+
+    if (!needs_quotes) {
+        writer_put(w, field, n);
+        return;
+    }
+
+    writer_put(w, "\"", 1);
+    for (size_t i = 0; i < n; i++) {
+        if (field[i] == '"') {
+            writer_put(w, "\"", 1);
+        }
+        writer_put(w, field + i, 1);
+    }
+    writer_put(w, "\"", 1);
+}
+
+/** A batch of input rows being processed in streaming mode. */
+typedef struct {
+    const char* field[STREAM_BATCH_ROWS]; /**< LNMP field of each row. */
+    size_t field_len[STREAM_BATCH_ROWS];  /**< Length of each LNMP field. */
+    int32_t lnmp[STREAM_BATCH_ROWS];      /**< Parsed LNMP day numbers. */
+    int32_t parse_status[STREAM_BATCH_ROWS];
+    int32_t edd[STREAM_BATCH_ROWS];
+    int32_t woa_weeks[STREAM_BATCH_ROWS];
+    int32_t woa_days[STREAM_BATCH_ROWS];
+    int32_t status[STREAM_BATCH_ROWS];
+    size_t changed[STREAM_BATCH_ROWS]; /**< Rows written in incremental mode. */
+    size_t count;                      /**< Rows in the batch. */
+    size_t first_row;                  /**< 1-based record number of the first row. */
+} stream_batch_t;
+
+/**
+ * Locates a column in a delimited line. Fields may be wrapped in double quotes, in which case
+ * delimiters inside them are ignored and the quotes are not part of the returned field.
+ * @param line Line bytes, without the newline.
+ * @param len Line length.
+ * @param column 1-based column number.
+ * @param delim Field separator.
+ * @param field_len Output field length; 0 if the line has fewer columns.
+ * @return Pointer to the start of the field inside line.
+ */
+static const char* find_field(const char* line, size_t len, size_t column, char delim,
+                              size_t* field_len) {
+    const char* end = line + len;
+    const char* p   = line;
+
+    // Skip the preceding columns
+    for (size_t skipped = 1; skipped < column; skipped++) {
+        bool quoted = false;
+        while (p < end && (quoted || *p != delim)) {
+            quoted ^= *p == '"';
+            p++;
+        }
+        if (p == end) {
+            *field_len = 0;
+            return end;
+        }
+        p++;
+    }
+
+    const char* field_end = p;
+    bool quoted           = false;
+    while (field_end < end && (quoted || *field_end != delim)) {
+        quoted ^= *field_end == '"';
+        field_end++;
+    }
+
+    if (field_end - p >= 2 && *p == '"' && field_end[-1] == '"') {
+        p++;
+        field_end--;
+    }
+
+    *field_len = (size_t)(field_end - p);
+    return p;
+}
+
+/**
+ * Writes the output row of one computed batch row.
+ * @param opts Streaming options.
+ * @param batch Computed rows.
+ * @param i Row index.
+ * @param w Output writer.
+ */
+static inline void stream_write_row(const stream_options_t* opts, const stream_batch_t* batch,
+                                    size_t i, writer_t* w) {
+    int status = batch->parse_status[i] != NAEGELES_OK ? batch->parse_status[i]
+                                                       : batch->status[i];
+
+    writer_put_field(w, batch->field[i], batch->field_len[i], opts->delim);
+    writer_put(w, &opts->delim, 1);
+    if (status == NAEGELES_OK || status == NAEGELES_ERR_FUTURE_DATE) {
+        writer_put_date(w, batch->edd[i]);
+    }
+    writer_put(w, &opts->delim, 1);
+    if (status == NAEGELES_OK) {
+        writer_put_uint(w, (unsigned)batch->woa_weeks[i]);
+        writer_put(w, &opts->delim, 1);
+        writer_put_uint(w, (unsigned)batch->woa_days[i]);
+    } else {
+        writer_put(w, &opts->delim, 1);
+    }
+    writer_put(w, &opts->delim, 1);
+
+    const char* message = naegeles_error_string(status);
+    writer_put(w, message, strlen(message));
+    writer_put(w, "\n", 1);
+}
+
+/**
+ * Runs the batch kernel over the collected rows and writes one output row per input row, or in
+ * incremental mode one row, prefixed with its record number, per changed input row.
+ * @param opts Streaming options.
+ * @param batch Collected rows; emptied on return.
+ * @param w Output writer.
+ */
+static void stream_flush_batch(const stream_options_t* opts, stream_batch_t* batch, writer_t* w) {
+    const naegeles_batch_t out = {batch->edd, batch->woa_weeks, batch->woa_days, batch->status};
+    naegeles_compute_batch_ctx(&opts->ctx, batch->lnmp, batch->count, &out);
+
+    if (opts->incremental) {
+        // Unparsable rows carry INT32_MIN, so they never count as changed
+        size_t changed = 0;
+        naegeles_select_changed(&opts->ctx, opts->since, batch->lnmp, batch->count,
+                                opts->change, batch->changed, &changed);
+        for (size_t k = 0; k < changed; k++) {
+            writer_put_size(w, batch->first_row + batch->changed[k]);
+            writer_put(w, &opts->delim, 1);
+            stream_write_row(opts, batch, batch->changed[k], w);
+        }
+    } else {
+        for (size_t i = 0; i < batch->count; i++) {
+            stream_write_row(opts, batch, i, w);
+        }
+    }
+
+    batch->first_row += batch->count;
+    batch->count = 0;
+}
+
+/**
+ * Processes every complete line in a buffer in place, without copying records. Blank lines are
+ * skipped and a trailing carriage return is ignored.
+ * @param opts Streaming options.
+ * @param data Buffer holding whole lines; the last line need not end in a newline.
+ * @param len Length of data.
+ * @param batch Scratch batch.
+ * @param w Output writer.
+ */
+static void stream_process_lines(const stream_options_t* opts, const char* data, size_t len,
+                                 stream_batch_t* batch, writer_t* w) {
+    const char* end = data + len;
+
+    while (data < end) {
+        const char* newline = memchr(data, '\n', (size_t)(end - data));
+        const char* line_end = newline != NULL ? newline : end;
+        size_t line_len      = (size_t)(line_end - data);
+
+        if (line_len > 0 && data[line_len - 1] == '\r') {
+            line_len--;
+        }
+
+        if (line_len > 0) {
+            const char* field = data;
+            size_t field_len  = line_len;
+            if (opts->column > 0) {
+                field = find_field(data, line_len, opts->column, opts->in_delim, &field_len);
+            }
+
+            size_t i            = batch->count++;
+            batch->field[i]     = field;
+            batch->field_len[i] = field_len;
+
+            batch->parse_status[i] =
+                naegeles_parse_date_layout(field, field_len, opts->layout, &batch->lnmp[i]);
+
+            // Keep unparsable rows out of the valid range so the kernel reports them too
+            if (batch->parse_status[i] != NAEGELES_OK) {
+                batch->lnmp[i] = INT32_MIN;
+            }
+
+            if (batch->count == STREAM_BATCH_ROWS) {
+                stream_flush_batch(opts, batch, w);
+            }
+        }
+
+        data = line_end + 1;
+    }
+
+    stream_flush_batch(opts, batch, w);
+}
+
+/** One worker's share of a parallel streaming round, with its own batch and output. */
+typedef struct {
+    const stream_options_t* opts;
+    const char* data; /**< Whole lines to process. */
+    size_t len;       /**< Length of data. */
+    size_t records;   /**< Non-blank lines in data, counted first in incremental mode. */
+    stream_batch_t batch;
+    writer_t out; /**< In-memory output, written in order once the round completes. */
+} stream_worker_t;
+
+/** State shared by the block reader and the memory-mapped path. */
+typedef struct {
+    stream_options_t* opts;   /**< Options; an AUTO layout is resolved in place. */
+    stream_batch_t* batch;    /**< Batch for single-threaded processing. */
+    stream_worker_t* workers; /**< opts->threads workers, or NULL when single-threaded. */
+    bool skip_header;         /**< The header line has not been dropped yet. */
+    size_t next_row;          /**< 1-based record number of the next record. */
+} stream_state_t;
+
+/**
+ * Worker step: processes one worker's lines into its in-memory writer.
+ * @param worker Worker.
+ */
+static void stream_worker_run(stream_worker_t* worker) {
+    worker->out.len = 0;
+    stream_process_lines(worker->opts, worker->data, worker->len, &worker->batch, &worker->out);
+}
+
+/**
+ * Counts the records (non-blank lines) in a buffer, as stream_process_lines would batch them.
+ * @param data Buffer holding whole lines.
+ * @param len Length of data.
+ * @return Number of records.
+ */
+static size_t stream_count_records(const char* data, size_t len) {
+    const char* end = data + len;
+    size_t records  = 0;
+
+    while (data < end) {
+        const char* newline  = memchr(data, '\n', (size_t)(end - data));
+        const char* line_end = newline != NULL ? newline : end;
+        size_t line_len      = (size_t)(line_end - data);
+        records += line_len > 1 || (line_len == 1 && data[0] != '\r');
+        data = line_end + 1;
+    }
+    return records;
+}
+
+/**
+ * Worker step: counts one worker's records.
+ * @param worker Worker.
+ */
+static void stream_worker_count(stream_worker_t* worker) {
+    worker->records = stream_count_records(worker->data, worker->len);
+}
+
+/** One step of a streaming round, run on every worker. */
+typedef struct {
+    stream_worker_t* workers;
+    void (*step)(stream_worker_t* worker);
+} stream_round_t;
+
+/**
+ * naegeles_run_tasks body: runs the round's step on one worker.
+ * @param arg Pointer to a stream_round_t.
+ * @param index Worker index.
+ */
+static void stream_round_task(void* arg, unsigned index) {
+    const stream_round_t* round = arg;
+    round->step(&round->workers[index]);
+}
+
+/**
+ * Runs a step on every worker, on the library's worker pool, and waits for all of them.
+ * @param st Streaming state with workers.
+ * @param step Step, passed the worker.
+ */
+static void stream_run_workers(stream_state_t* st, void (*step)(stream_worker_t* worker)) {
+    stream_round_t round = {st->workers, step};
+    naegeles_run_tasks(stream_round_task, &round, st->opts->threads);
+}
+
+/**
+ * Processes whole lines on the worker threads. The input is consumed in rounds of at most
+ * threads * STREAM_SEGMENT_SIZE bytes, split into one piece per worker on line boundaries;
+ * each round's output is written in input order once every worker has finished. Incremental
+ * mode counts each piece's records first, so every worker knows its first record number.
+ * @param st Streaming state with workers.
+ * @param data Buffer holding whole lines.
+ * @param len Length of data.
+ * @param w Output writer.
+ */
+static void stream_parallel(stream_state_t* st, const char* data, size_t len, writer_t* w) {
+    const unsigned threads = st->opts->threads;
+    const char* end        = data + len;
+
+    while (data < end) {
+        size_t round    = (size_t)(end - data);
+        size_t max_size = (size_t)threads * STREAM_SEGMENT_SIZE;
+        round           = round < max_size ? round : max_size;
+
+        const char* piece = data;
+
+        for (unsigned t = 0; t < threads; t++) {
+            // Cut at this worker's nominal share, extended to the end of the line it falls in
+            const char* cut = data + round * (t + 1) / threads;
+            cut             = cut < piece ? piece : cut;
+            if (cut > data && cut < end && cut[-1] != '\n') {
+                const char* newline = memchr(cut, '\n', (size_t)(end - cut));
+                cut                 = newline != NULL ? newline + 1 : end;
+            }
+
+            stream_worker_t* worker = &st->workers[t];
+            worker->data            = piece;
+            worker->len             = (size_t)(cut - piece);
+            piece                   = cut;
+        }
+
+        if (st->opts->incremental) {
+            stream_run_workers(st, stream_worker_count);
+            for (unsigned t = 0; t < threads; t++) {
+                st->workers[t].batch.first_row = st->next_row;
+                st->next_row += st->workers[t].records;
+            }
+        }
+        stream_run_workers(st, stream_worker_run);
+
+        for (unsigned t = 0; t < threads; t++) {
+            writer_put_block(w, st->workers[t].out.buf, st->workers[t].out.len);
+            w->failed |= st->workers[t].out.failed;
+        }
+
+        data = piece;
+    }
+}
+
+/**
+ * Resolves an AUTO input layout from the first non-blank record, falling back to dd/mm/yyyy
+ * if it matches no layout. Leaves it unresolved if data holds only blank lines.
+ * @param opts Streaming options.
+ * @param data Buffer holding whole lines.
+ * @param len Length of data.
+ */
+static void stream_detect_layout(stream_options_t* opts, const char* data, size_t len) {
+    const char* end = data + len;
+
+    while (data < end) {
+        const char* newline  = memchr(data, '\n', (size_t)(end - data));
+        const char* line_end = newline != NULL ? newline : end;
+        size_t line_len      = (size_t)(line_end - data);
+
+        if (line_len > 0 && data[line_len - 1] == '\r') {
+            line_len--;
+        }
+
+        if (line_len > 0) {
+            const char* field = data;
+            size_t field_len  = line_len;
+            if (opts->column > 0) {
+                field = find_field(data, line_len, opts->column, opts->in_delim, &field_len);
+            }
+
+            int layout   = naegeles_detect_layout(field, field_len);
+            opts->layout = layout >= 0 ? (naegeles_date_layout_t)layout
+                                       : NAEGELES_LAYOUT_DMY_SLASH;
+            return;
+        }
+
+        data = line_end + 1;
+    }
+}
+
+/**
+ * Processes whole lines, dropping the header line first if requested.
+ * @param st Streaming state.
+ * @param data Buffer holding whole lines.
+ * @param len Length of data.
+ * @param w Output writer.
+ */
+static void stream_span(stream_state_t* st, const char* data, size_t len, writer_t* w) {
+    if (st->skip_header && len > 0) {
+        const char* newline = memchr(data, '\n', len);
+        const char* next    = newline != NULL ? newline + 1 : data + len;
+        len -= (size_t)(next - data);
+        data            = next;
+        st->skip_header = false;
+    }
+
+    if (st->opts->layout == NAEGELES_LAYOUT_AUTO) {
+        stream_detect_layout(st->opts, data, len);
+    }
+
+    if (st->workers != NULL) {
+        stream_parallel(st, data, len, w);
+    } else {
+        st->batch->first_row = st->next_row;
+        stream_process_lines(st->opts, data, len, st->batch, w);
+        st->next_row = st->batch->first_row;
+    }
+}
+
+/**
+ * Writes the output header row.
+ * @param opts Streaming options.
+ * @param w Output writer.
+ */
+static void stream_write_header(const stream_options_t* opts, writer_t* w) {
+    static const char* const columns[] = {"row", "lnmp", "edd", "woa_weeks", "woa_days", "status"};
+    const size_t count                 = sizeof(columns) / sizeof(columns[0]);
+
+    // The row column only appears in incremental mode
+    for (size_t i = opts->incremental ? 0 : 1; i < count; i++) {
+        writer_put(w, columns[i], strlen(columns[i]));
+        writer_put(w, i + 1 < count ? &opts->delim : "\n", 1);
+    }
+}
+
+/**
+ * Reads LNMP records, one per line, and writes one CSV/TSV row per record.
+ * Per-line errors are reported in the status column and do not stop the run.
+ * @param in Input stream.
+ * @param st Streaming state.
+ * @param w Output writer.
+ * @return true on success, false on an I/O or allocation error.
+ */
+static bool stream_run(FILE* in, stream_state_t* st, writer_t* w) {
+    // Parallel mode reads a whole round at a time so every worker gets a full segment
+    const size_t buf_size = st->workers != NULL
+                                ? (size_t)st->opts->threads * STREAM_SEGMENT_SIZE
+                                : STREAM_BUF_SIZE;
+    char* buf             = malloc(buf_size);
+    if (buf == NULL) {
+        return false;
+    }
+
+    size_t pending = 0;      // Bytes of an incomplete line carried over from the previous read
+    bool skipping  = false;  // Discarding the rest of a line too long for the buffer
+    for (;;) {
+        size_t n = fread(buf + pending, 1, buf_size - pending, in);
+        if (n == 0) {
+            break;
+        }
+        n += pending;
+
+        // Process up to the last newline; keep the tail for the next read
+        const char* last_newline = NULL;
+        for (size_t i = n; i > 0; i--) {
+            if (buf[i - 1] == '\n') {
+                last_newline = buf + i - 1;
+                break;
+            }
+        }
+
+        if (last_newline == NULL) {
+            if (n < buf_size) {
+                pending = n;
+                continue;
+            }
+
+            // A line longer than the buffer can never be a valid record: report it once,
+            // truncated, and discard the rest of it
+            if (!skipping) {
+                stream_span(st, buf, STREAM_OVERLONG_FIELD, w);
+            }
+            skipping = true;
+            pending  = 0;
+            continue;
+        }
+
+        const char* start = buf;
+        if (skipping) {
+            start    = (const char*)memchr(buf, '\n', n) + 1;
+            skipping = false;
+        }
+
+        // After an overlong line, its newline can be the only one in the buffer
+        if (start <= last_newline) {
+            stream_span(st, start, (size_t)(last_newline - start), w);
+        }
+        pending = (size_t)(buf + n - (last_newline + 1));
+        memmove(buf, last_newline + 1, pending);
+    }
+
+    if (pending > 0 && !skipping) {
+        stream_span(st, buf, pending, w);
+    }
+
+    bool ok = !ferror(in);
+    free(buf);
+    return ok;
+}
+
+/**
+ * Maps a regular file into memory and processes it in place.
+ * @param fd Open file descriptor.
+ * @param size File size in bytes (greater than 0).
+ * @param st Streaming state.
+ * @param w Output writer.
+ * @return true on success, false if the file could not be mapped.
+ */
+static bool stream_mapped(int fd, size_t size, stream_state_t* st, writer_t* w) {
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+    stream_span(st, data, size, w);
+    munmap(data, size);
+    return true;
+}
+
+/**
+ * Prints CLI usage.
+ * @param prog Program name.
+ */
+static void print_usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--input-format F] LNMP\n"
+            "       %s --stream [--tsv] [--as-of dd/mm/yyyy] [--column N [--delimiter C]]\n"
+            "          [--header] [--input-format F] [--threads N]\n"
+            "          [--since dd/mm/yyyy [--changed weeks|days]] [FILE]\n"
+            "       %s --serve unix:PATH|tcp:[HOST:]PORT|http:[HOST:]PORT [--threads N]\n"
+            "  (the first two forms also accept --stats)\n"
+            "\n"
+            "  --stream     Read one LNMP per line from FILE (or stdin) and write\n"
+            "               lnmp,edd,woa_weeks,woa_days,status rows to stdout.\n"
+            "  --tsv        Separate output fields with tabs instead of commas.\n"
+            "  --as-of      Measure WOA against this date instead of today.\n"
+            "  --column     Take the LNMP from 1-based CSV column N of each line.\n"
+            "  --delimiter  Input field separator for --column (default ',').\n"
+            "  --header     Skip the first input line.\n"
+            "  --input-format\n"
+            "               LNMP layout: dmy (dd/mm/yyyy, default), dmy-dash (dd-mm-yyyy),\n"
+            "               iso (yyyy-mm-dd), compact (yyyymmdd), or auto (detected from\n"
+            "               the first record).\n"
+            "  --since      Incremental mode: only write rows whose status or WOA differs\n"
+            "               from a run at this earlier (or later) reference date, each\n"
+            "               prefixed with its 1-based record number (header and blank\n"
+            "               lines excluded) in a leading row column.\n"
+            "  --changed    With --since, compare completed weeks only (weeks, default)\n"
+            "               or every WOA change (days).\n"
+            "  --serve      Answer binary (unix:, tcp:) or HTTP/JSON (http:, POST /v1/edd)\n"
+            "               EDD/WOA requests until killed; see edd_server.h.\n"
+            "  --threads    Process input or run the server on N threads (0 = one per CPU).\n"
+            "  --stats      Print call, stage, error and latency counters to stderr as JSON\n"
+            "               (needs a build with -DNAEGELES_STATS).\n",
+            prog, prog, prog);
+}
+
+/**
+ * Runs streaming mode. Regular files are memory-mapped; pipes and stdin are read in blocks.
+ * @param path Input file, or NULL or "-" for stdin.
+ * @param opts Streaming options.
+ * @return 0 on success, 1 on error.
+ */
+static int run_stream(const char* path, stream_options_t* opts) {
+    FILE* in = stdin;
+    if (path != NULL && strcmp(path, "-") != 0 && (in = fopen(path, "rb")) == NULL) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        return 1;
+    }
+
+    writer_t w            = {.file = stdout, .buf = malloc(STREAM_OUT_BUF_SIZE),
+                             .cap  = STREAM_OUT_BUF_SIZE};
+    stream_state_t state  = {.opts = opts, .skip_header = opts->header, .next_row = 1};
+    state.batch           = malloc(sizeof(*state.batch));
+    bool ok               = w.buf != NULL && state.batch != NULL;
+
+    if (ok && opts->threads > 1) {
+        state.workers = calloc(opts->threads, sizeof(*state.workers));
+        ok            = state.workers != NULL;
+        for (unsigned t = 0; ok && t < opts->threads; t++) {
+            stream_worker_t* worker = &state.workers[t];
+            worker->opts            = opts;
+            worker->out.buf         = malloc(STREAM_OUT_BUF_SIZE);
+            worker->out.cap         = STREAM_OUT_BUF_SIZE;
+            ok                      = worker->out.buf != NULL;
+        }
+    }
+
+    if (ok) {
+        state.batch->count = 0;
+        stream_write_header(opts, &w);
+
+        struct stat st;
+        bool mapped = false;
+        if (fstat(fileno(in), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            mapped = stream_mapped(fileno(in), (size_t)st.st_size, &state, &w);
+        }
+        if (!mapped) {
+            ok = stream_run(in, &state, &w);
+        }
+    }
+
+    ok = writer_flush(&w) && ok && fflush(stdout) == 0;
+    free(w.buf);
+    free(state.batch);
+    if (state.workers != NULL) {
+        for (unsigned t = 0; t < opts->threads; t++) {
+            free(state.workers[t].out.buf);
+        }
+        free(state.workers);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: streaming failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Computes and prints the EDD and WOA of a single LNMP.
+ * @param lnmp LNMP in the --input-format layout (dd/mm/yyyy by default).
+ * @param opts Options holding the reference date and layout.
+ * @return 0 on success, 1 on error.
+ */
+static int run_single(const char* lnmp, const stream_options_t* opts) {
+    char edd[DATE_STR_MAX_LEN];
+    char woa[WOA_STR_MAX_LEN];
+
+    // Other layouts are normalized to dd/mm/yyyy for the string API
+    char normalized[DATE_STR_MAX_LEN];
+    if (opts->layout != NAEGELES_LAYOUT_DMY_SLASH) {
+        int32_t days = 0;
+        int parsed   = naegeles_parse_date_layout(lnmp, strlen(lnmp), opts->layout, &days);
+        if (parsed != NAEGELES_OK) {
+            fprintf(stderr, "Error: %s\n", naegeles_error_string(parsed));
+            return 1;
+        }
+        naegeles_format_date(days, normalized, sizeof(normalized));
+        normalized[DATE_STR_LEN] = '\0';
+        lnmp                     = normalized;
+    }
+
+    int result = naegeles_compute_asof(lnmp, opts->ctx.as_of, edd, sizeof(edd), woa, sizeof(woa));
+
+    if (result != NAEGELES_OK) {
+        fprintf(stderr, "Error: %s\n", naegeles_error_string(result));
+        return 1;
+    }
+
+    printf("EDD: %s\n", edd);
+    printf("WOA: %s\n", woa);
+
+    return 0;
+}
+
+/**
+ * Prints a JSON array of counters to stderr.
+ * @param name Field name.
+ * @param values Counters.
+ * @param count Number of counters.
+ */
+static void print_stats_array(const char* name, const uint64_t* values, size_t count) {
+    fprintf(stderr, ",\n  \"%s\": [", name);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(stderr, "%s%llu", i > 0 ? ", " : "", (unsigned long long)values[i]);
+    }
+    fprintf(stderr, "]");
+}
+
+/**
+ * Prints the library's NAEGELES_STATS counters to stderr as JSON (--stats).
+ */
+static void print_stats(void) {
+    naegeles_stats_t snap;
+    naegeles_stats_snapshot(&snap);
+    if (!snap.enabled) {
+        fprintf(stderr, "Warning: --stats needs a build with -DNAEGELES_STATS\n");
+        return;
+    }
+
+    // Error counts are keyed by message, in naegeles_error_t order
+    fprintf(stderr, "{\n  \"tick_unit\": \"%s\",\n  \"calls\": %llu,\n  \"batch_calls\": %llu,\n"
+            "  \"batch_rows\": %llu,\n  \"parse_rows\": %llu",
+            snap.ticks_are_cycles ? "cycles" : "ns", (unsigned long long)snap.calls,
+            (unsigned long long)snap.batch_calls, (unsigned long long)snap.batch_rows,
+            (unsigned long long)snap.parse_rows);
+
+    static const char* const stages[NAEGELES_STAGE_COUNT] = {"parse", "edd", "woa", "format",
+                                                              "batch"};
+    fprintf(stderr, ",\n  \"stage_ticks\": {");
+    for (int i = 0; i < NAEGELES_STAGE_COUNT; i++) {
+        fprintf(stderr, "%s\"%s\": %llu", i > 0 ? ", " : "", stages[i],
+                (unsigned long long)snap.stage_ticks[i]);
+    }
+    fprintf(stderr, "}");
+
+    fprintf(stderr, ",\n  \"errors\": {");
+    for (int i = 0; i < NAEGELES_ERROR_CODES; i++) {
+        fprintf(stderr, "%s\"%s\": %llu", i > 0 ? ", " : "", naegeles_error_string(-i),
+                (unsigned long long)snap.errors[i]);
+    }
+    fprintf(stderr, "}");
+
+    print_stats_array("latency_log2_ticks", snap.latency, NAEGELES_LATENCY_BUCKETS);
+    fprintf(stderr, "\n}\n");
+}
+
+/**
+ * Looks up an --input-format name.
+ * @param name "dmy", "dmy-dash", "iso", "compact" or "auto".
+ * @param layout Output layout.
+ * @return true if the name is known.
+ */
+static bool parse_layout_name(const char* name, naegeles_date_layout_t* layout) {
+    // Indexed by naegeles_date_layout_t
+    static const char* const names[] = {"dmy", "dmy-dash", "iso", "compact", "auto"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *layout = (naegeles_date_layout_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Entry point for the CLI Naegele's rule EDD/WOA calculator.
+ * @param argc Argument count.
+ * @param argv Argument vector. Expects LNMP date in dd/mm/yyyy format, --stream options and
+ * an optional input file, or --serve and an address.
+ * @return 0 on success, 1 on error.
+ */
+int main(int argc, char* argv[]) {
+    bool stream           = false;
+    bool stats            = false;
+    const char* operand   = NULL;
+    const char* as_of     = NULL;
+    const char* serve     = NULL;
+    const char* since     = NULL;
+    stream_options_t opts = {.delim = ',', .in_delim = ',', .threads = 1};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serve = argv[++i];
+        } else if (strcmp(argv[i], "--tsv") == 0) {
+            opts.delim = '\t';
+        } else if (strcmp(argv[i], "--as-of") == 0 && i + 1 < argc) {
+            as_of = argv[++i];
+        } else if (strcmp(argv[i], "--column") == 0 && i + 1 < argc) {
+            char* end   = NULL;
+            opts.column = strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || opts.column == 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--delimiter") == 0 && i + 1 < argc) {
+            const char* delim = argv[++i];
+            opts.in_delim     = strcmp(delim, "\\t") == 0 ? '\t' : delim[0];
+            if (delim[0] == '\0') {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--input-format") == 0 && i + 1 < argc) {
+            if (!parse_layout_name(argv[++i], &opts.layout)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--since") == 0 && i + 1 < argc) {
+            since = argv[++i];
+        } else if (strcmp(argv[i], "--changed") == 0 && i + 1 < argc) {
+            const char* change = argv[++i];
+            if (strcmp(change, "weeks") == 0) {
+                opts.change = NAEGELES_CHANGED_WEEKS;
+            } else if (strcmp(change, "days") == 0) {
+                opts.change = NAEGELES_CHANGED_DAYS;
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--header") == 0) {
+            opts.header = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            char* end    = NULL;
+            opts.threads = naegeles_resolve_threads((unsigned)strtoul(argv[++i], &end, 10));
+            if (*end != '\0') {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (operand == NULL && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            operand = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (serve != NULL) {
+        return naegeles_serve(serve, opts.threads);
+    }
+
+    int result = as_of != NULL ? naegeles_parse_date(as_of, &opts.ctx.as_of)
+                               : naegeles_context_init(&opts.ctx);
+    if (result == NAEGELES_OK && since != NULL) {
+        opts.incremental = true;
+        result           = naegeles_parse_date(since, &opts.since);
+    }
+    if (result != NAEGELES_OK) {
+        fprintf(stderr, "Error: %s\n", naegeles_error_string(result));
+        return 1;
+    }
+
+    if (!stream && operand == NULL) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    int status = stream ? run_stream(operand, &opts) : run_single(operand, &opts);
+    if (stats) {
+        print_stats();
+    }
+    return status;
+}
@@ -0,0 +1,1058 @@
+/**
+ * Daemon mode for the edd CLI: an epoll event loop serving the packed binary protocol or the
+ * HTTP/JSON endpoint described in edd_server.h. Each loop thread owns its connections; all
+ * threads share one listening socket and wake one at a time for new connections
+ * (EPOLLEXCLUSIVE).
+ */
+#define _GNU_SOURCE  // for accept4, memmem, SOCK_NONBLOCK, SOCK_CLOEXEC, EPOLLEXCLUSIVE
+
+#include "edd_server.h"
+
+#include "edd.h"
+
+#include <stdbool.h>  // for bool, true, false
+#include <stddef.h>   // for size_t
+#include <stdint.h>   // for int32_t, uint32_t
+#include <stdio.h>    // for fprintf, perror
+#include <string.h>   // for memcpy, memmem, memmove, strncmp, strlen, strrchr
+
+#ifdef __linux__
+#include <errno.h>        // for errno, EAGAIN, EINTR
+#include <netdb.h>        // for getaddrinfo, freeaddrinfo, gai_strerror
+#include <netinet/in.h>   // for IPPROTO_TCP
+#include <netinet/tcp.h>  // for TCP_NODELAY
+#include <pthread.h>      // for pthread_t, pthread_create, pthread_detach
+#include <stdlib.h>       // for malloc, free, strtoull
+#include <strings.h>      // for strncasecmp
+#include <sys/epoll.h>    // for epoll_create1, epoll_ctl, epoll_wait
+#include <sys/socket.h>   // for socket, bind, listen, accept4, send, setsockopt
+#include <sys/stat.h>     // for lstat, S_ISSOCK
+#include <sys/un.h>       // for struct sockaddr_un
+#include <unistd.h>       // for close, read, unlink
+
+/** Bytes of pending requests buffered per connection. */
+#define SERVER_READ_BUF_SIZE (16 << 10)
+
+/** Most requests answered per read. */
+#define SERVER_MAX_REQUESTS (SERVER_READ_BUF_SIZE / NAEGELES_SERVER_REQUEST_SIZE)
+
+/** Room for the responses to one full read buffer. */
+#define SERVER_WRITE_BUF_SIZE (SERVER_MAX_REQUESTS * NAEGELES_SERVER_RESPONSE_SIZE)
+
+/** Events handled per epoll_wait call. */
+#define SERVER_MAX_EVENTS 256
+
+/** Pending connection queue length passed to listen. */
+#define SERVER_BACKLOG 1024
+
+/** JSON body elements collected per HTTP batch call. */
+#define SERVER_HTTP_BATCH 256
+
+/** Upper bound on one formatted HTTP result object. */
+#define SERVER_HTTP_ROW_MAX 80
+
+/** Room for one HTTP response head, chunk framing and a 100 Continue. */
+#define SERVER_HTTP_HEAD_MAX 512
+
+_Static_assert(SERVER_HTTP_BATCH * SERVER_HTTP_ROW_MAX + SERVER_HTTP_HEAD_MAX <=
+                   SERVER_WRITE_BUF_SIZE,
+               "an HTTP batch must fit in the write buffer");
+_Static_assert(SERVER_HTTP_BATCH <= SERVER_MAX_REQUESTS, "HTTP batches use the loop scratch");
+
+/** Where the JSON body parser is within the top-level array. */
+typedef enum {
+    JSON_START,   /**< Before '['. */
+    JSON_FIRST,   /**< After '[': a string or ']'. */
+    JSON_STRING,  /**< Inside a string element. */
+    JSON_ESCAPE,  /**< After a backslash inside a string. */
+    JSON_UNICODE, /**< Inside the four hex digits of a \u escape. */
+    JSON_AFTER,   /**< After an element: ',' or ']'. */
+    JSON_NEXT,    /**< After ',': a string. */
+    JSON_END,     /**< After ']': only whitespace. */
+    JSON_ERROR    /**< Malformed body. */
+} json_state_t;
+
+/** Progress through the current HTTP request (http: listeners only). */
+typedef struct {
+    bool in_body;       /**< The head has been parsed; body_left bytes of JSON remain. */
+    bool started;       /**< The response head has been written. */
+    bool chunked;       /**< HTTP/1.1 chunked reply; HTTP/1.0 replies end at close instead. */
+    bool keep_alive;    /**< Keep the connection open after this reply. */
+    bool wrote_element; /**< A result object has been written; the next needs a comma. */
+    bool str_bad;       /**< The current string has a non-ASCII escape and cannot be a date. */
+    json_state_t json;
+    size_t str_len;               /**< Characters in the current string element so far. */
+    unsigned hex_left;            /**< Hex digits of the current \u escape still to come. */
+    unsigned hex_value;           /**< Code unit of the current \u escape so far. */
+    unsigned long long body_left; /**< Body bytes not yet consumed. */
+    int32_t as_of;                /**< Reference day number for this request. */
+    size_t count;                 /**< Elements collected in records. */
+    char records[SERVER_HTTP_BATCH][DATE_STR_LEN];
+} server_http_t;
+
+/** One client connection. */
+typedef struct {
+    int fd;
+    bool eof;       /**< The client has shut down its side, or the server will close after
+                         the pending replies. */
+    size_t in_len;  /**< Bytes buffered in in_buf; at most one partial request stays behind. */
+    size_t out_pos; /**< First unsent byte of out_buf. */
+    size_t out_len; /**< Bytes of responses in out_buf. */
+    unsigned char in_buf[SERVER_READ_BUF_SIZE];
+    unsigned char out_buf[SERVER_WRITE_BUF_SIZE];
+    server_http_t http;
+} server_conn_t;
+
+/** State of one event loop thread, including scratch arrays for the batch kernel. */
+typedef struct {
+    int listen_fd;
+    int epoll_fd;
+    bool http;        /**< Connections speak HTTP/JSON instead of the binary protocol. */
+    bool today_valid; /**< today holds the local date for the current wakeup. */
+    int today_status; /**< Result of reading the clock for this wakeup. */
+    int32_t today;
+    int32_t lnmp[SERVER_MAX_REQUESTS];
+    int32_t as_of[SERVER_MAX_REQUESTS];
+    int32_t edd[SERVER_MAX_REQUESTS];
+    int32_t woa_weeks[SERVER_MAX_REQUESTS];
+    int32_t woa_days[SERVER_MAX_REQUESTS];
+    int32_t status[SERVER_MAX_REQUESTS];
+} server_loop_t;
+
+/**
+ * Reads a little-endian int32.
+ * @param p Source bytes.
+ * @return Decoded value.
+ */
+static inline int32_t load_le32(const unsigned char* p) {
+    return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+                     (uint32_t)p[3] << 24);
+}
+
+/**
+ * Writes a little-endian int32.
+ * @param p Destination bytes.
+ * @param value Value to encode.
+ */
+static inline void store_le32(unsigned char* p, int32_t value) {
+    uint32_t v = (uint32_t)value;
+    p[0]       = (unsigned char)v;
+    p[1]       = (unsigned char)(v >> 8);
+    p[2]       = (unsigned char)(v >> 16);
+    p[3]       = (unsigned char)(v >> 24);
+}
+
+/**
+ * Resolves NAEGELES_SERVER_TODAY, reading the clock at most once per wakeup.
+ * @param loop Event loop.
+ * @param as_of Output reference day number.
+ * @return NAEGELES_OK, or NAEGELES_ERR_SYSTEM_TIME if the clock is unavailable.
+ */
+static int server_today(server_loop_t* loop, int32_t* as_of) {
+    if (!loop->today_valid) {
+        naegeles_context_t ctx = {0};
+        loop->today_status = naegeles_context_init(&ctx);
+        loop->today        = ctx.as_of;
+        loop->today_valid  = true;
+    }
+    *as_of = loop->today;
+    return loop->today_status;
+}
+
+/**
+ * Answers every complete request in the connection's input buffer with one batch call per
+ * run of equal reference dates, and appends the responses to its output buffer (which must be
+ * empty). A trailing partial request is kept for the next read.
+ * @param loop Event loop providing scratch arrays.
+ * @param conn Connection.
+ */
+static void server_answer(server_loop_t* loop, server_conn_t* conn) {
+    size_t count = conn->in_len / NAEGELES_SERVER_REQUEST_SIZE;
+
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char* request = conn->in_buf + i * NAEGELES_SERVER_REQUEST_SIZE;
+        loop->lnmp[i]                = load_le32(request);
+        loop->as_of[i]               = load_le32(request + 4);
+    }
+
+    for (size_t begin = 0, end = 0; begin < count; begin = end) {
+        end = begin + 1;
+        while (end < count && loop->as_of[end] == loop->as_of[begin]) {
+            end++;
+        }
+
+        naegeles_context_t ctx = {.as_of = loop->as_of[begin]};
+        int result             = NAEGELES_OK;
+        if (ctx.as_of == NAEGELES_SERVER_TODAY) {
+            result = server_today(loop, &ctx.as_of);
+        }
+
+        const naegeles_batch_t out = {loop->edd + begin, loop->woa_weeks + begin,
+                                      loop->woa_days + begin, loop->status + begin};
+        if (result == NAEGELES_OK) {
+            naegeles_compute_batch_ctx(&ctx, loop->lnmp + begin, end - begin, &out);
+        } else {
+            for (size_t i = begin; i < end; i++) {
+                loop->edd[i]       = 0;
+                loop->woa_weeks[i] = 0;
+                loop->woa_days[i]  = 0;
+                loop->status[i]    = result;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        unsigned char* response = conn->out_buf + i * NAEGELES_SERVER_RESPONSE_SIZE;
+        store_le32(response, loop->edd[i]);
+        store_le32(response + 4, loop->woa_weeks[i]);
+        store_le32(response + 8, loop->woa_days[i]);
+        store_le32(response + 12, loop->status[i]);
+    }
+    conn->out_pos = 0;
+    conn->out_len = count * NAEGELES_SERVER_RESPONSE_SIZE;
+
+    size_t used  = count * NAEGELES_SERVER_REQUEST_SIZE;
+    conn->in_len -= used;
+    memmove(conn->in_buf, conn->in_buf + used, conn->in_len);
+}
+
+/**
+ * Appends bytes to the connection's output buffer. Callers stay within the sizes checked by
+ * the static asserts above.
+ * @param conn Connection.
+ * @param data Bytes to append.
+ * @param len Number of bytes.
+ */
+static void out_put(server_conn_t* conn, const char* data, size_t len) {
+    memcpy(conn->out_buf + conn->out_len, data, len);
+    conn->out_len += len;
+}
+
+/** Appends a string literal to the connection's output buffer. */
+#define OUT_LITERAL(conn, text) out_put((conn), (text), sizeof(text) - 1)
+
+/**
+ * Appends a signed decimal integer.
+ * @param conn Connection.
+ * @param value Value to format.
+ */
+static void out_put_int(server_conn_t* conn, int32_t value) {
+    if (value < 0) {
+        OUT_LITERAL(conn, "-");
+    }
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    conn->out_len += (size_t)naegeles_format_uint(
+        magnitude, (char*)conn->out_buf + conn->out_len, SERVER_WRITE_BUF_SIZE - conn->out_len);
+}
+
+/**
+ * Appends a day number as a quoted "dd/mm/yyyy" JSON string.
+ * @param conn Connection.
+ * @param days Day number of a supported date.
+ */
+static void out_put_date(server_conn_t* conn, int32_t days) {
+    OUT_LITERAL(conn, "\"");
+    conn->out_len += (size_t)naegeles_format_date(
+        days, (char*)conn->out_buf + conn->out_len, SERVER_WRITE_BUF_SIZE - conn->out_len);
+    OUT_LITERAL(conn, "\"");
+}
+
+/**
+ * Fails the current HTTP request and closes the connection after the reply. Once a 200 reply
+ * has started the status can no longer change, so the connection is just dropped.
+ * @param conn Connection.
+ * @param status Status code and reason, e.g. "400 Bad Request".
+ * @param message Error message for the JSON body.
+ */
+static void http_error(server_conn_t* conn, const char* status, const char* message) {
+    conn->eof    = true;
+    conn->in_len = 0;
+    if (conn->http.started) {
+        return;
+    }
+
+    char body[128];
+    int body_len = snprintf(body, sizeof(body), "{\"error\":\"%s\"}", message);
+    int len      = snprintf((char*)conn->out_buf + conn->out_len,
+                            SERVER_WRITE_BUF_SIZE - conn->out_len,
+                            "HTTP/1.1 %s\r\nContent-Type: application/json\r\n"
+                            "Content-Length: %d\r\nConnection: close\r\n\r\n%s",
+                            status, body_len, body);
+    conn->out_len += (size_t)len;
+}
+
+/**
+ * Runs the collected body elements through the batch API and appends their results as one
+ * reply chunk, writing the reply head first if needed. The final chunk also closes the array
+ * and the chunked body.
+ * @param loop Event loop providing scratch arrays.
+ * @param conn Connection.
+ * @param final True once the whole body has been parsed.
+ */
+static void http_emit(server_loop_t* loop, server_conn_t* conn, bool final) {
+    server_http_t* h = &conn->http;
+    bool first       = !h->started;
+
+    if (first) {
+        if (!h->chunked) {
+            OUT_LITERAL(conn, "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\n"
+                              "Connection: close\r\n\r\n");
+        } else if (h->keep_alive) {
+            OUT_LITERAL(conn, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                              "Transfer-Encoding: chunked\r\n\r\n");
+        } else {
+            OUT_LITERAL(conn, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                              "Transfer-Encoding: chunked\r\nConnection: close\r\n\r\n");
+        }
+        h->started = true;
+    }
+
+    // The chunk size is patched in as four hex digits once the chunk is written
+    size_t chunk_start = conn->out_len;
+    if (h->chunked) {
+        conn->out_len += 6;
+    }
+    if (first) {
+        OUT_LITERAL(conn, "[");
+    }
+
+    if (h->count > 0) {
+        naegeles_parse_batch(&h->records[0][0], DATE_STR_LEN, h->count, loop->lnmp, loop->status);
+        for (size_t i = 0; i < h->count; i++) {
+            if (loop->status[i] != NAEGELES_OK) {
+                loop->lnmp[i] = INT32_MIN;  // Out of range, so the batch reports it as invalid
+            }
+        }
+
+        const naegeles_context_t ctx = {.as_of = h->as_of};
+        const naegeles_batch_t out   = {loop->edd, loop->woa_weeks, loop->woa_days, loop->status};
+        naegeles_compute_batch_ctx(&ctx, loop->lnmp, h->count, &out);
+
+        for (size_t i = 0; i < h->count; i++) {
+            int32_t status = loop->status[i];
+            if (h->wrote_element) {
+                OUT_LITERAL(conn, ",");
+            }
+            OUT_LITERAL(conn, "{\"edd\":");
+            if (status == NAEGELES_OK || status == NAEGELES_ERR_FUTURE_DATE) {
+                out_put_date(conn, loop->edd[i]);
+            } else {
+                OUT_LITERAL(conn, "null");
+            }
+            if (status == NAEGELES_OK) {
+                OUT_LITERAL(conn, ",\"woa_weeks\":");
+                out_put_int(conn, loop->woa_weeks[i]);
+                OUT_LITERAL(conn, ",\"woa_days\":");
+                out_put_int(conn, loop->woa_days[i]);
+            } else {
+                OUT_LITERAL(conn, ",\"woa_weeks\":null,\"woa_days\":null");
+            }
+            OUT_LITERAL(conn, ",\"status\":");
+            out_put_int(conn, status);
+            OUT_LITERAL(conn, "}");
+            h->wrote_element = true;
+        }
+        h->count = 0;
+    }
+
+    if (final) {
+        OUT_LITERAL(conn, "]");
+    }
+
+    if (h->chunked) {
+        static const char hex[] = "0123456789abcdef";
+        size_t size             = conn->out_len - chunk_start - 6;
+        unsigned char* p        = conn->out_buf + chunk_start;
+        p[0]                    = (unsigned char)hex[size >> 12 & 0xf];
+        p[1]                    = (unsigned char)hex[size >> 8 & 0xf];
+        p[2]                    = (unsigned char)hex[size >> 4 & 0xf];
+        p[3]                    = (unsigned char)hex[size & 0xf];
+        p[4]                    = '\r';
+        p[5]                    = '\n';
+        OUT_LITERAL(conn, "\r\n");
+        if (final) {
+            OUT_LITERAL(conn, "0\r\n\r\n");
+        }
+    }
+
+    if (final) {
+        h->in_body = false;
+        conn->eof  = conn->eof || !h->keep_alive;
+    }
+}
+
+/**
+ * Returns true if a header name matches, ignoring case.
+ * @param name Header name (not NUL-terminated).
+ * @param len Length of name.
+ * @param expected Lower-case name to compare against.
+ */
+static bool header_is(const char* name, size_t len, const char* expected) {
+    return len == strlen(expected) && strncasecmp(name, expected, len) == 0;
+}
+
+/**
+ * Returns true if a header value contains a token, ignoring case.
+ * @param value Header value (not NUL-terminated).
+ * @param len Length of value.
+ * @param token Lower-case token.
+ */
+static bool header_has(const char* value, size_t len, const char* token) {
+    size_t token_len = strlen(token);
+    for (size_t i = 0; i + token_len <= len; i++) {
+        if (strncasecmp(value + i, token, token_len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads the reference date from the query string's as_of parameter, or today's date.
+ * @param loop Event loop.
+ * @param query Query string after '?' (not NUL-terminated), or NULL.
+ * @param len Length of query.
+ * @param as_of Output reference day number.
+ * @return NAEGELES_OK, or an error code for an invalid date or unavailable clock.
+ */
+static int http_as_of(server_loop_t* loop, const char* query, size_t len, int32_t* as_of) {
+    for (size_t i = 0; query != NULL && i < len;) {
+        const char* param = query + i;
+        const char* amp   = memchr(param, '&', len - i);
+        size_t param_len  = amp != NULL ? (size_t)(amp - param) : len - i;
+        i += param_len + 1;
+        if (param_len < 6 || strncmp(param, "as_of=", 6) != 0) {
+            continue;
+        }
+
+        // Accept the slashes raw or percent-encoded
+        char date[DATE_STR_MAX_LEN];
+        size_t n = 0;
+        for (size_t j = 6; j < param_len; j++) {
+            char c = param[j];
+            if (c == '%' && j + 2 < param_len && param[j + 1] == '2' &&
+                (param[j + 2] == 'F' || param[j + 2] == 'f')) {
+                c = '/';
+                j += 2;
+            }
+            if (n + 1 >= sizeof(date)) {
+                return NAEGELES_ERR_INVALID_DATE;
+            }
+            date[n++] = c;
+        }
+        date[n] = '\0';
+        return naegeles_parse_date(date, as_of);
+    }
+    return server_today(loop, as_of);
+}
+
+/**
+ * Parses a complete request head from the input buffer and consumes it, or fails the request.
+ * Does nothing while the head is incomplete.
+ * @param loop Event loop.
+ * @param conn Connection.
+ */
+static void http_parse_head(server_loop_t* loop, server_conn_t* conn) {
+    const char* head = (const char*)conn->in_buf;
+    const char* end  = memmem(head, conn->in_len, "\r\n\r\n", 4);
+    if (end == NULL) {
+        if (conn->in_len == SERVER_READ_BUF_SIZE) {
+            http_error(conn, "431 Request Header Fields Too Large", "request head too large");
+        }
+        return;
+    }
+
+    // Request line: METHOD SP TARGET SP VERSION
+    const char* eol    = memmem(head, (size_t)(end + 2 - head), "\r\n", 2);
+    const char* sp1    = memchr(head, ' ', (size_t)(eol - head));
+    const char* target = sp1 != NULL ? sp1 + 1 : NULL;
+    const char* sp2    = target != NULL ? memchr(target, ' ', (size_t)(eol - target)) : NULL;
+    if (sp2 == NULL || eol - (sp2 + 1) != 8 || strncmp(sp2 + 1, "HTTP/1.", 7) != 0) {
+        http_error(conn, "400 Bad Request", "malformed request line");
+        return;
+    }
+
+    server_http_t* h     = &conn->http;
+    bool http10          = sp2[8] == '0';
+    bool have_length     = false;
+    bool expect_continue = false;
+    bool chunked_upload  = false;
+    h->chunked           = !http10;
+    h->keep_alive        = !http10;
+    h->body_left         = 0;
+
+    for (const char* line = eol + 2; line < end + 2;) {
+        const char* next  = memmem(line, (size_t)(end + 2 - line), "\r\n", 2);
+        const char* colon = memchr(line, ':', (size_t)(next - line));
+        if (colon == NULL) {
+            http_error(conn, "400 Bad Request", "malformed header");
+            return;
+        }
+        size_t name_len   = (size_t)(colon - line);
+        const char* value = colon + 1;
+        const char* value_end = next;
+        while (value < value_end && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+        while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+            value_end--;
+        }
+        size_t value_len = (size_t)(value_end - value);
+
+        if (header_is(line, name_len, "content-length")) {
+            have_length  = value_len > 0;
+            h->body_left = 0;
+            for (size_t i = 0; i < value_len && have_length; i++) {
+                have_length  = value[i] >= '0' && value[i] <= '9' && h->body_left < (1ull << 60);
+                h->body_left = h->body_left * 10 + (unsigned)(value[i] - '0');
+            }
+        } else if (header_is(line, name_len, "transfer-encoding")) {
+            chunked_upload = true;
+        } else if (header_is(line, name_len, "connection") &&
+                   header_has(value, value_len, "close")) {
+            h->keep_alive = false;
+        } else if (header_is(line, name_len, "expect") &&
+                   header_has(value, value_len, "100-continue")) {
+            expect_continue = !http10;
+        }
+        line = next + 2;
+    }
+
+    const char* query    = memchr(target, '?', (size_t)(sp2 - target));
+    const char* path_end = query != NULL ? query : sp2;
+    if (path_end - target != 7 || strncmp(target, "/v1/edd", 7) != 0) {
+        http_error(conn, "404 Not Found", "unknown path");
+        return;
+    }
+    if (sp1 - head != 4 || strncmp(head, "POST", 4) != 0) {
+        http_error(conn, "405 Method Not Allowed", "use POST");
+        return;
+    }
+    if (chunked_upload || !have_length) {
+        http_error(conn, "411 Length Required", "the body needs a Content-Length");
+        return;
+    }
+
+    size_t query_len = query != NULL ? (size_t)(sp2 - query - 1) : 0;
+    int result       = http_as_of(loop, query != NULL ? query + 1 : NULL, query_len, &h->as_of);
+    if (result == NAEGELES_ERR_SYSTEM_TIME) {
+        http_error(conn, "500 Internal Server Error", "system time unavailable");
+        return;
+    }
+    if (result != NAEGELES_OK) {
+        http_error(conn, "400 Bad Request", "as_of must be dd/mm/yyyy");
+        return;
+    }
+
+    if (expect_continue && h->body_left > 0) {
+        OUT_LITERAL(conn, "HTTP/1.1 100 Continue\r\n\r\n");
+    }
+
+    h->in_body       = true;
+    h->started       = false;
+    h->wrote_element = false;
+    h->json          = JSON_START;
+    h->count         = 0;
+
+    size_t used = (size_t)(end + 4 - head);
+    conn->in_len -= used;
+    memmove(conn->in_buf, conn->in_buf + used, conn->in_len);
+}
+
+/**
+ * Appends one decoded character to the current string element.
+ * @param h HTTP request state.
+ * @param c Character.
+ */
+static inline void json_put(server_http_t* h, char c) {
+    if (h->str_len < DATE_STR_LEN) {
+        h->records[h->count][h->str_len] = c;
+    }
+    h->str_len++;
+}
+
+/**
+ * Decodes the character after a backslash in a JSON string.
+ * @param c Escape character.
+ * @return The character it stands for, or 0 if it is not a single-character escape.
+ */
+static inline char json_unescape(unsigned char c) {
+    switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            return (char)c;
+        case 'b':
+            return '\b';
+        case 'f':
+            return '\f';
+        case 'n':
+            return '\n';
+        case 'r':
+            return '\r';
+        case 't':
+            return '\t';
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Advances the JSON body parser by one byte. Completed string elements are stored in the
+ * batch records, with escapes decoded; anything that cannot be a dd/mm/yyyy date is stored so
+ * it fails to parse.
+ * @param h HTTP request state.
+ * @param c Next body byte.
+ */
+static void json_step(server_http_t* h, unsigned char c) {
+    bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+
+    switch (h->json) {
+        case JSON_START:
+            h->json = c == '[' ? JSON_FIRST : space ? JSON_START : JSON_ERROR;
+            break;
+        case JSON_FIRST:
+        case JSON_NEXT:
+            if (c == '"') {
+                h->json    = JSON_STRING;
+                h->str_len = 0;
+                h->str_bad = false;
+            } else if (c == ']' && h->json == JSON_FIRST) {
+                h->json = JSON_END;
+            } else if (!space) {
+                h->json = JSON_ERROR;
+            }
+            break;
+        case JSON_STRING:
+            if (c == '"') {
+                if (h->str_len != DATE_STR_LEN || h->str_bad) {
+                    h->records[h->count][2] = '?';
+                }
+                h->count++;
+                h->json = JSON_AFTER;
+            } else if (c == '\\') {
+                h->json = JSON_ESCAPE;
+            } else {
+                json_put(h, (char)c);
+            }
+            break;
+        case JSON_ESCAPE:
+            if (c == 'u') {
+                h->hex_left  = 4;
+                h->hex_value = 0;
+                h->json      = JSON_UNICODE;
+            } else if (json_unescape(c) != 0) {
+                json_put(h, json_unescape(c));
+                h->json = JSON_STRING;
+            } else {
+                h->json = JSON_ERROR;
+            }
+            break;
+        case JSON_UNICODE: {
+            unsigned digit = c >= '0' && c <= '9'   ? c - '0'
+                             : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                             : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                                    : 16;
+            if (digit == 16) {
+                h->json = JSON_ERROR;
+                break;
+            }
+            h->hex_value = h->hex_value << 4 | digit;
+            if (--h->hex_left == 0) {
+                // Only ASCII can be part of a date
+                h->str_bad |= h->hex_value >= 0x80 || h->hex_value == 0;
+                json_put(h, (char)h->hex_value);
+                h->json = JSON_STRING;
+            }
+            break;
+        }
+        case JSON_AFTER:
+            h->json = c == ',' ? JSON_NEXT : c == ']' ? JSON_END : space ? JSON_AFTER : JSON_ERROR;
+            break;
+        case JSON_END:
+            h->json = space ? JSON_END : JSON_ERROR;
+            break;
+        case JSON_ERROR:
+            break;
+    }
+}
+
+/**
+ * Feeds buffered body bytes to the JSON parser, stopping after each full batch so its reply
+ * chunk can drain, and finishes the reply at the end of the body.
+ * @param loop Event loop.
+ * @param conn Connection.
+ */
+static void http_feed(server_loop_t* loop, server_conn_t* conn) {
+    server_http_t* h = &conn->http;
+    size_t avail     = conn->in_len < h->body_left ? conn->in_len : (size_t)h->body_left;
+    size_t used      = 0;
+
+    while (used < avail) {
+        json_step(h, conn->in_buf[used++]);
+        if (h->json == JSON_ERROR) {
+            http_error(conn, "400 Bad Request", "the body must be a JSON array of strings");
+            return;
+        }
+        if (h->count == SERVER_HTTP_BATCH) {
+            http_emit(loop, conn, false);
+            break;
+        }
+    }
+
+    h->body_left -= used;
+    conn->in_len -= used;
+    memmove(conn->in_buf, conn->in_buf + used, conn->in_len);
+
+    if (h->body_left == 0) {
+        if (h->json != JSON_END) {
+            http_error(conn, "400 Bad Request", "the body must be a JSON array of strings");
+        } else {
+            http_emit(loop, conn, true);
+        }
+    }
+}
+
+/**
+ * Makes one step of progress on an HTTP connection: parses a request head, or feeds body bytes.
+ * The output buffer must be empty.
+ * @param loop Event loop.
+ * @param conn Connection.
+ * @return true if input was consumed or output produced; false if more input is needed.
+ */
+static bool http_answer(server_loop_t* loop, server_conn_t* conn) {
+    size_t in_before = conn->in_len;
+    if (conn->eof && in_before == 0) {
+        return false;
+    }
+
+    if (!conn->http.in_body) {
+        http_parse_head(loop, conn);
+    } else {
+        http_feed(loop, conn);
+    }
+    return conn->in_len != in_before || conn->out_len > 0;
+}
+
+/**
+ * Sends as much pending output as the socket accepts.
+ * @param conn Connection.
+ * @return false if the connection failed and must be closed.
+ */
+static bool server_flush(server_conn_t* conn) {
+    while (conn->out_pos < conn->out_len) {
+        ssize_t sent = send(conn->fd, conn->out_buf + conn->out_pos, conn->out_len - conn->out_pos,
+                            MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn->out_pos += (size_t)sent;
+    }
+
+    conn->out_pos = 0;
+    conn->out_len = 0;
+    return true;
+}
+
+/**
+ * Closes a connection and frees it.
+ * @param conn Connection.
+ */
+static void server_close(server_conn_t* conn) {
+    close(conn->fd);  // Also removes it from the epoll set
+    free(conn);
+}
+
+/**
+ * Reads and answers requests until the socket is drained or its replies back up. While replies
+ * are pending the connection waits for EPOLLOUT instead of reading more.
+ * @param loop Event loop.
+ * @param conn Connection.
+ * @return false if the connection was closed.
+ */
+static bool server_serve(server_loop_t* loop, server_conn_t* conn) {
+    for (;;) {
+        if (!server_flush(conn)) {
+            server_close(conn);
+            return false;
+        }
+        if (conn->out_len > 0) {
+            break;
+        }
+
+        // HTTP answers stop after each reply chunk; resume on input that is already buffered
+        if (loop->http && http_answer(loop, conn)) {
+            continue;
+        }
+        if (conn->eof) {
+            break;
+        }
+
+        ssize_t got = read(conn->fd, conn->in_buf + conn->in_len,
+                           SERVER_READ_BUF_SIZE - conn->in_len);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            server_close(conn);
+            return false;
+        }
+
+        conn->eof = got == 0;
+        conn->in_len += (size_t)got;
+        if (!loop->http) {
+            server_answer(loop, conn);
+        }
+    }
+
+    if (conn->eof && conn->out_len == 0) {
+        server_close(conn);
+        return false;
+    }
+
+    struct epoll_event event = {.events = conn->out_len > 0 ? EPOLLOUT : EPOLLIN,
+                                .data.ptr = conn};
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    return true;
+}
+
+/**
+ * Accepts every pending connection and registers it with the loop.
+ * @param loop Event loop.
+ */
+static void server_accept(server_loop_t* loop) {
+    for (;;) {
+        int fd = accept4(loop->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // EAGAIN: another thread took it, or the queue is empty
+        }
+
+        // Replies are small and latency-bound; fails harmlessly on Unix sockets
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        server_conn_t* conn = malloc(sizeof(*conn));
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        *conn = (server_conn_t){.fd = fd};
+
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = conn};
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            server_close(conn);
+        }
+    }
+}
+
+/**
+ * Runs one event loop forever.
+ * @param arg server_loop_t with listen_fd set.
+ * @return NULL if the loop could not be set up.
+ */
+static void* server_loop_run(void* arg) {
+    server_loop_t* loop = arg;
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0) {
+        perror("epoll_create1");
+        return NULL;
+    }
+
+    // The listener has a NULL data pointer; connections carry their server_conn_t
+    struct epoll_event listen_event = {.events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &listen_event) != 0) {
+        perror("epoll_ctl");
+        close(loop->epoll_fd);
+        return NULL;
+    }
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    for (;;) {
+        int ready = epoll_wait(loop->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        loop->today_valid = false;
+        for (int i = 0; i < ready; i++) {
+            server_conn_t* conn = events[i].data.ptr;
+            if (conn == NULL) {
+                server_accept(loop);
+            } else if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0 &&
+                       (events[i].events & EPOLLIN) == 0) {
+                server_close(conn);
+            } else {
+                server_serve(loop, conn);
+            }
+        }
+    }
+
+    close(loop->epoll_fd);
+    return NULL;
+}
+
+/**
+ * Creates a listening Unix domain socket, replacing a stale socket file at the same path.
+ * @param path Socket path.
+ * @return Listening descriptor, or -1 on error.
+ */
+static int server_listen_unix(const char* path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path too long: %s\n", path);
+        return -1;
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (const struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, SERVER_BACKLOG) != 0) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Creates a listening TCP socket.
+ * @param spec "PORT" or "HOST:PORT".
+ * @return Listening descriptor, or -1 on error.
+ */
+static int server_listen_tcp(const char* spec) {
+    char host[256] = "";
+    const char* port  = spec;
+    const char* colon = strrchr(spec, ':');
+    if (colon != NULL) {
+        size_t host_len = (size_t)(colon - spec);
+        if (host_len >= sizeof(host)) {
+            fprintf(stderr, "Error: host name too long: %s\n", spec);
+            return -1;
+        }
+        memcpy(host, spec, host_len);
+        host[host_len] = '\0';
+        port           = colon + 1;
+    }
+
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM,
+                             .ai_flags = AI_PASSIVE};
+    struct addrinfo* list = NULL;
+    int err               = getaddrinfo(host[0] != '\0' ? host : NULL, port, &hints, &list);
+    if (err != 0) {
+        fprintf(stderr, "Error: %s: %s\n", spec, gai_strerror(err));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo* ai = list; ai != NULL && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, SERVER_BACKLOG) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(list);
+
+    if (fd < 0) {
+        fprintf(stderr, "Error: cannot listen on %s\n", spec);
+    }
+    return fd;
+}
+
+/**
+ * Runs the server; see edd_server.h.
+ * @param address "unix:PATH", "tcp:[HOST:]PORT" or "http:[HOST:]PORT".
+ * @param threads Event loop threads (at least 1).
+ * @return 1 on failure.
+ */
+int naegeles_serve(const char* address, unsigned threads) {
+    int listen_fd = -1;
+    bool http     = false;
+    if (strncmp(address, "unix:", 5) == 0) {
+        listen_fd = server_listen_unix(address + 5);
+    } else if (strncmp(address, "tcp:", 4) == 0) {
+        listen_fd = server_listen_tcp(address + 4);
+    } else if (strncmp(address, "http:", 5) == 0) {
+        listen_fd = server_listen_tcp(address + 5);
+        http      = true;
+    } else {
+        fprintf(stderr, "Error: address must be unix:PATH, tcp:[HOST:]PORT or http:[HOST:]PORT\n");
+    }
+    if (listen_fd < 0) {
+        return 1;
+    }
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    server_loop_t* loops = calloc(threads, sizeof(*loops));
+    if (loops == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        close(listen_fd);
+        return 1;
+    }
+
+    // Extra loops run detached; the calling thread runs the first one
+    for (unsigned t = 0; t < threads; t++) {
+        loops[t].listen_fd = listen_fd;
+        loops[t].http      = http;
+    }
+    for (unsigned t = 1; t < threads; t++) {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, server_loop_run, &loops[t]) == 0) {
+            pthread_detach(tid);
+        }
+    }
+
+    server_loop_run(&loops[0]);
+
+    // Only reached if the first loop failed; the process exits, taking the other loops with it
+    free(loops);
+    close(listen_fd);
+    return 1;
+}
+
+#else
+
+/**
+ * Fallback for platforms without epoll.
+ * @param address Unused.
+ * @param threads Unused.
+ * @return 1.
+ */
+int naegeles_serve(const char* address, unsigned threads) {
+    (void)address;
+    (void)threads;
+    fprintf(stderr, "Error: daemon mode needs Linux (epoll)\n");
+    return 1;
+}
+
+#endif  // __linux__
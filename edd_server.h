@@ -0,0 +1,56 @@
+/**
+ * Daemon mode for the edd CLI (edd_server.c): a long-running epoll server answering packed
+ * binary requests over a Unix socket or TCP, or JSON requests over HTTP.
+ *
+ * Protocol. A client writes any number of back-to-back requests and reads one response per
+ * request, in order. All integers are little-endian and there is no padding or framing.
+ *
+ *   request  (8 bytes):  int32 lnmp   LNMP day number (days since 1970-01-01)
+ *                        int32 as_of  reference day number, or NAEGELES_SERVER_TODAY
+ *   response (16 bytes): int32 edd        EDD day number
+ *                        int32 woa_weeks  completed weeks
+ *                        int32 woa_days   remaining days (0-6)
+ *                        int32 status     naegeles_error_t code, as in the batch API
+ *
+ * Every request read in one go is answered by one batch call per run of equal as_of values
+ * and one write.
+ *
+ * HTTP. An "http:" listener serves one endpoint on keep-alive HTTP/1.1 connections:
+ *
+ *   POST /v1/edd[?as_of=dd/mm/yyyy]   body: JSON array of dd/mm/yyyy strings
+ *
+ * The body may use Content-Length only (no chunked uploads) and is parsed as it arrives, in
+ * batches fed straight to the batch API. Strings may contain any JSON escape; an element that
+ * is not a date once decoded gets an error status, not a 4xx. The reply is a chunked JSON
+ * array with one object per element, in order:
+ *
+ *   {"edd":"dd/mm/yyyy","woa_weeks":11,"woa_days":4,"status":0}
+ *
+ * where status is the naegeles_error_t code; edd is null unless status is NAEGELES_OK or
+ * NAEGELES_ERR_FUTURE_DATE, and the WOA fields are null unless it is NAEGELES_OK. Malformed
+ * requests get a 4xx JSON {"error": ...} reply; if the body turns out to be malformed after the
+ * reply has started, the connection is closed without the final chunk.
+ */
+#ifndef EDD_SERVER_H
+#define EDD_SERVER_H
+
+#include <stdint.h>  // for INT32_MIN
+
+/** Size of one request in bytes. */
+#define NAEGELES_SERVER_REQUEST_SIZE 8
+
+/** Size of one response in bytes. */
+#define NAEGELES_SERVER_RESPONSE_SIZE 16
+
+/** as_of value that asks for today's local date. */
+#define NAEGELES_SERVER_TODAY INT32_MIN
+
+/**
+ * Runs the server until it fails; does not return on success.
+ * @param address "unix:PATH", "tcp:[HOST:]PORT" (binary protocol) or "http:[HOST:]PORT".
+ * @param threads Event loop threads sharing the listening socket (at least 1).
+ * @return 1 if the server could not start or a fatal error occurred.
+ */
+int naegeles_serve(const char* address, unsigned threads);
+
+#endif  // EDD_SERVER_H
@@ -0,0 +1,1605 @@
+/**
+ * Exhaustive differential self-check of edd.c (the edd_verify test binary) and a libFuzzer
+ * entry point for its parsers; see edd_verify.h.
+ */
+#define _POSIX_C_SOURCE 200809L  // for snprintf, vfprintf
+
+#include "edd_verify.h"
+
+#include <pthread.h>   // for pthread_t, pthread_create, pthread_join, pthread_mutex_t
+#include <stdarg.h>    // for va_list, va_start, va_end
+#include <stdatomic.h> // for atomic_size_t, atomic_fetch_add, atomic_store
+#include <stdbool.h>   // for bool, true, false
+#include <stddef.h>    // for size_t
+#include <stdint.h>    // for int8_t, int16_t, int32_t, int64_t, uint8_t, uint32_t, uint64_t,
+                       // INT16_MAX, INT32_MIN, INT32_MAX
+#include <stdio.h>     // for printf, fprintf, snprintf, vfprintf
+#include <stdlib.h>    // for malloc, calloc, free, abort, strtoul
+#include <string.h>    // for memcmp, memcpy, memset, strcmp
+
+#include "edd.h"
+#include "edd_arrow.h"
+
+/** First year of the reference calendar; a year before the earliest LNMP is rejected. */
+#define REF_FIRST_YEAR 1898
+
+/** Last year of the reference calendar, with room for the EDDs of LNMPs past 2100. */
+#define REF_LAST_YEAR 2103
+
+/** Years in the reference calendar. */
+#define REF_YEARS (REF_LAST_YEAR - REF_FIRST_YEAR + 1)
+
+/** Upper bound on the days in the reference calendar. */
+#define REF_MAX_DAYS (REF_YEARS * 366)
+
+/** Range of valid LNMP years, as documented in edd.h. */
+#define REF_MIN_YEAR 1900
+#define REF_MAX_YEAR 2100
+
+/** Years of the dates pass: the valid range and one rejected year on each side. */
+#define DATES_FIRST_YEAR (REF_MIN_YEAR - 1)
+#define DATES_LAST_YEAR  (REF_MAX_YEAR + 1)
+
+/** Day and month fields of the dates pass: 0-32 and 0-13, so every bound is crossed. */
+#define DATES_DAYS   33
+#define DATES_MONTHS 14
+
+/** Records per year and layout in the dates pass. */
+#define DATES_RECORDS (DATES_DAYS * DATES_MONTHS)
+
+/** LNMPs per reference date in the offsets pass: 46 weeks before it to 2 weeks after it. */
+#define OFFSET_PAST_DAYS   322
+#define OFFSET_FUTURE_DAYS 14
+#define OFFSET_WINDOW      (OFFSET_PAST_DAYS + OFFSET_FUTURE_DAYS + 1)
+
+/** Stride that scrambles the offsets window; OFFSET_WINDOW is prime, so any stride works. */
+#define OFFSET_STEP 101
+
+_Static_assert(OFFSET_WINDOW == 337, "OFFSET_WINDOW must stay prime");
+
+/** Copies of the window in the dedup batch, enough rows per day for its table path. */
+#define OFFSET_REPEAT 4
+
+/** Reference dates of the offsets pass past each end of the valid range. */
+#define OFFSET_MARGIN 30
+
+/** Reference dates per offsets work unit. */
+#define OFFSET_BLOCK 64
+
+/** LNMPs of the spans pass past each end of the valid range. */
+#define SPAN_MARGIN 400
+
+/** Distance between the reference dates sampled by the spans pass (prime, so every WOA day
+ * and weekday shows up). */
+#define SPAN_STRIDE 1009
+
+/** Reference dates sampled by the spans pass; the last is past the vector WOA limit. */
+#define SPAN_SAMPLES 160
+
+/** Threads naegeles_compute_batch_parallel is asked for in the spans pass. */
+#define SPAN_PARALLEL_THREADS 2
+
+/** Reference dates sampled by the arrow pass, and the distance between them (prime). */
+#define ARROW_SAMPLES 8
+#define ARROW_STRIDE  9973
+
+/** Work units of the arrow pass: the samples, the int16 week limit, the spans pass's extreme
+ * reference dates, and one unit for rejected inputs. */
+#define ARROW_UNITS (ARROW_SAMPLES + 1 + SPAN_EDGES + 1)
+
+/** Smallest slice offset of the arrow pass; not a multiple of 8, so validity bits are read
+ * across byte boundaries. */
+#define ARROW_SLICE_OFFSET 13
+
+/** Columns of a naegeles_arrow_compute result, and its validity bitmaps with the struct's. */
+#define ARROW_COLUMNS 4
+#define ARROW_BITMAPS (1 + ARROW_COLUMNS)
+
+/** Work units of the text pass, plus one for edge values. */
+#define TEXT_BLOCKS 16
+
+/** Weeks formatted per text unit, with every day count. */
+#define TEXT_WEEKS_PER_BLOCK 1024
+
+/** Integers formatted per text unit. */
+#define TEXT_UINTS_PER_BLOCK 65536
+
+/** Mismatches described on stderr; the rest are only counted. */
+#define VERIFY_MAX_REPORTS 20
+
+/** Functions under test, in report order. */
+enum {
+    CHECK_PARSE_DATE,
+    CHECK_PARSE_LAYOUT,
+    CHECK_DETECT_LAYOUT,
+    CHECK_PARSE_BATCH,
+    CHECK_DATE_TO_DAYS,
+    CHECK_DAYS_TO_DATE,
+    CHECK_FORMAT_DATE,
+    CHECK_COMPUTE_EDD,
+    CHECK_COMPUTE_ASOF,
+    CHECK_COMPUTE_WOA_ASOF,
+    CHECK_COMPUTE_RESULT,
+    CHECK_BATCH_CTX,
+    CHECK_BATCH_DEDUP,
+    CHECK_BATCH_METHODS,
+    CHECK_BATCH_PARALLEL,
+    CHECK_SELECT_CHANGED,
+    CHECK_ARROW_COMPUTE,
+    CHECK_FORMAT_WOA,
+    CHECK_FORMAT_UINT,
+    CHECK_COUNT
+};
+
+/** Report names of the checks. */
+static const char* const check_names[CHECK_COUNT] = {
+    "naegeles_parse_date",
+    "naegeles_parse_date_layout",
+    "naegeles_detect_layout",
+    "naegeles_parse_batch_layout",
+    "naegeles_date_to_days",
+    "naegeles_days_to_date",
+    "naegeles_format_date",
+    "naegeles_compute_edd",
+    "naegeles_compute_asof",
+    "naegeles_compute_woa_asof",
+    "naegeles_compute_result_asof",
+    "naegeles_compute_batch_ctx",
+    "naegeles_compute_batch_dedup",
+    "naegeles_compute_batch_methods",
+    "naegeles_compute_batch_parallel",
+    "naegeles_select_changed",
+    "naegeles_arrow_compute",
+    "naegeles_format_woa",
+    "naegeles_format_uint",
+};
+
+/**
+ * Reference calendar, built by walking every day from REF_FIRST_YEAR to REF_LAST_YEAR. Days
+ * are stored by index; day number d (days since 1970-01-01) is index d + epoch.
+ */
+typedef struct {
+    int32_t month_start[REF_YEARS][14];        /**< Index of the 1st of months 1-12, and of the
+                                                    next 1 January at 13. */
+    int16_t year[REF_MAX_DAYS];                /**< Civil date of each index. */
+    uint8_t month[REF_MAX_DAYS];
+    uint8_t day[REF_MAX_DAYS];
+    char text[REF_MAX_DAYS][DATE_STR_LEN + 1]; /**< dd/mm/yyyy of each index. */
+    int32_t edd[REF_MAX_DAYS];                 /**< EDD day number of each valid LNMP index. */
+    char woa[OFFSET_PAST_DAYS + 1][WOA_STR_MAX_LEN]; /**< WOA text of 0 to OFFSET_PAST_DAYS. */
+    int16_t crl_ga[UINT8_MAX + 1];             /**< Gestational age per CRL in mm, or -1. */
+    int16_t bpd_ga[UINT8_MAX + 1];             /**< Gestational age per BPD in mm, or -1. */
+    int32_t days;                              /**< Days in the calendar. */
+    int32_t epoch;                             /**< Index of 1970-01-01. */
+    int32_t first_valid;                       /**< Day number of the earliest valid LNMP. */
+    int32_t last_valid;                        /**< Day number of the latest valid LNMP. */
+} ref_calendar_t;
+
+static ref_calendar_t ref;
+
+/** One expected batch row. */
+typedef struct {
+    int32_t edd;
+    int32_t weeks;
+    int32_t days;
+    int32_t status;
+} ref_row_t;
+
+/**
+ * Returns the day number of a civil date, letting the day run past the end of its month.
+ * @param day Day of month (at least 1).
+ * @param month Month (1-12).
+ * @param year Year (REF_FIRST_YEAR to REF_LAST_YEAR).
+ * @return Day number.
+ */
+static int32_t ref_days(int day, int month, int year) {
+    return ref.month_start[year - REF_FIRST_YEAR][month] + day - 1 - ref.epoch;
+}
+
+/**
+ * Tells whether a civil date exists in the reference calendar.
+ * @param day Day of month.
+ * @param month Month.
+ * @param year Year.
+ */
+static bool ref_exists(int day, int month, int year) {
+    if (year < REF_FIRST_YEAR || year > REF_LAST_YEAR || month < 1 || month > 12 || day < 1) {
+        return false;
+    }
+    const int32_t* starts = ref.month_start[year - REF_FIRST_YEAR];
+    return day <= starts[month + 1] - starts[month];
+}
+
+/**
+ * Tells whether a civil date is a valid LNMP.
+ * @param day Day of month.
+ * @param month Month.
+ * @param year Year.
+ */
+static bool ref_valid(int day, int month, int year) {
+    return year >= REF_MIN_YEAR && year <= REF_MAX_YEAR && ref_exists(day, month, year);
+}
+
+/**
+ * Tells whether a day number is a valid LNMP.
+ * @param days Day number.
+ */
+static bool ref_valid_days(int64_t days) {
+    return days >= ref.first_valid && days <= ref.last_valid;
+}
+
+/**
+ * Moves a date back 3 months and on 1 year, keeping the day of month; a day past the end of
+ * the new month rolls over into the next.
+ * @param days Day number inside the reference calendar.
+ * @return Shifted day number.
+ */
+static int32_t ref_shift_months(int32_t days) {
+    const int32_t i = days + ref.epoch;
+    int month       = ref.month[i];
+    int year        = ref.year[i];
+    if (month > 3) {
+        month -= 3;
+        year += 1;
+    } else {
+        month += 9;
+    }
+    return ref_days(ref.day[i], month, year);
+}
+
+/**
+ * Writes a civil date in a record layout with snprintf, NUL-terminated.
+ * @param day Day field (0-99).
+ * @param month Month field (0-99).
+ * @param year Year field (0-9999).
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ * @param out Output with room for DATE_STR_LEN + 1 bytes.
+ * @return Record length.
+ */
+static size_t ref_format_civil(int day, int month, int year, int layout, char* out) {
+    const unsigned d = (unsigned)day % 100, m = (unsigned)month % 100, y = (unsigned)year % 10000;
+    switch (layout) {
+        case NAEGELES_LAYOUT_DMY_DASH:
+            return (size_t)snprintf(out, DATE_STR_LEN + 1, "%02u-%02u-%04u", d, m, y);
+        case NAEGELES_LAYOUT_ISO:
+            return (size_t)snprintf(out, DATE_STR_LEN + 1, "%04u-%02u-%02u", y, m, d);
+        case NAEGELES_LAYOUT_COMPACT:
+            return (size_t)snprintf(out, DATE_STR_LEN + 1, "%04u%02u%02u", y, m, d);
+        default:
+            return (size_t)snprintf(out, DATE_STR_LEN + 1, "%02u/%02u/%04u", d, m, y);
+    }
+}
+
+/**
+ * Writes a WOA as "N weeks" or "N weeks, M days" (singular for 1) with snprintf.
+ * @param weeks Completed weeks.
+ * @param days Remaining days (0-6).
+ * @param out Output with room for WOA_STR_MAX_LEN bytes.
+ * @return Length written.
+ */
+static size_t ref_format_woa(uint32_t weeks, uint32_t days, char* out) {
+    int n = snprintf(out, WOA_STR_MAX_LEN, "%u week%s", weeks, weeks == 1 ? "" : "s");
+    if (days > 0) {
+        n += snprintf(out + n, WOA_STR_MAX_LEN - (size_t)n, ", %u day%s", days,
+                      days == 1 ? "" : "s");
+    }
+    return (size_t)n;
+}
+
+/**
+ * Returns the square root of a positive number by Newton's method, which converges to the
+ * correctly rounded root from above.
+ * @param x Positive number.
+ */
+static double ref_sqrt(double x) {
+    double y = x > 1 ? x : 1;
+    for (double next = (y + x / y) / 2; next < y; next = (y + x / y) / 2) {
+        y = next;
+    }
+    return y;
+}
+
+/**
+ * Builds the reference calendar, its strings, EDDs and gestational ages. Idempotent; not
+ * thread-safe.
+ */
+static void ref_init(void) {
+    static const int lengths[13] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (ref.days != 0) {
+        return;
+    }
+
+    int32_t index = 0;
+    for (int year = REF_FIRST_YEAR; year <= REF_LAST_YEAR; year++) {
+        const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        for (int month = 1; month <= 12; month++) {
+            ref.month_start[year - REF_FIRST_YEAR][month] = index;
+            const int length = lengths[month] + (month == 2 && leap);
+            for (int day = 1; day <= length; day++, index++) {
+                ref.year[index]  = (int16_t)year;
+                ref.month[index] = (uint8_t)month;
+                ref.day[index]   = (uint8_t)day;
+                ref_format_civil(day, month, year, NAEGELES_LAYOUT_DMY_SLASH, ref.text[index]);
+            }
+        }
+        ref.month_start[year - REF_FIRST_YEAR][13] = index;
+    }
+    ref.days        = index;
+    ref.epoch       = ref.month_start[1970 - REF_FIRST_YEAR][1];
+    ref.first_valid = ref_days(1, 1, REF_MIN_YEAR);
+    ref.last_valid  = ref_days(31, 12, REF_MAX_YEAR);
+
+    // Naegele's rule: +7 days, -3 months, +1 year
+    for (int32_t days = ref.first_valid; days <= ref.last_valid; days++) {
+        ref.edd[days + ref.epoch] = ref_shift_months(days + 7);
+    }
+    for (uint32_t total = 0; total <= OFFSET_PAST_DAYS; total++) {
+        ref_format_woa(total / 7, total % 7, ref.woa[total]);
+    }
+
+    // The published formulas behind edd.h's CRL (Robinson) and BPD (Hadlock) methods
+    for (int mm = 0; mm <= UINT8_MAX; mm++) {
+        const double cm = mm / 10.0;
+        ref.crl_ga[mm]  = mm < 10 || mm > 84 ? -1 : (int16_t)(8.052 * ref_sqrt(mm) + 23.73 + 0.5);
+        ref.bpd_ga[mm]  = mm < 20 || mm > 100
+                              ? -1
+                              : (int16_t)(7 * (9.54 + 1.482 * cm + 0.1676 * cm * cm) + 0.5);
+    }
+}
+
+/**
+ * Returns the expected row for an EDD and a WOA counted from origin.
+ * @param as_of Reference date.
+ * @param origin Start of gestation.
+ * @param edd EDD day number.
+ */
+static ref_row_t ref_woa_row(int32_t as_of, int32_t origin, int32_t edd) {
+    const int64_t total = (int64_t)as_of - origin;
+    if (total < 0) {
+        return (ref_row_t){edd, 0, 0, NAEGELES_ERR_FUTURE_DATE};
+    }
+    return (ref_row_t){edd, (int32_t)(total / 7), (int32_t)(total % 7), NAEGELES_OK};
+}
+
+/**
+ * Returns the expected naegeles_compute_batch_ctx row.
+ * @param as_of Reference date.
+ * @param lnmp LNMP day number (any value).
+ */
+static ref_row_t ref_lnmp_row(int32_t as_of, int32_t lnmp) {
+    if (!ref_valid_days(lnmp)) {
+        return (ref_row_t){0, 0, 0, NAEGELES_ERR_INVALID_DATE};
+    }
+    return ref_woa_row(as_of, lnmp, ref.edd[lnmp + ref.epoch]);
+}
+
+/**
+ * Returns the expected naegeles_compute_batch_methods row, from the method descriptions in
+ * edd.h. The Naegele family is rejected when the date its rule is applied to (LNMP-equivalent
+ * plus 7 days, less 7) leaves the valid range.
+ * @param as_of Reference date.
+ * @param date Row date.
+ * @param method naegeles_method_t value (any).
+ * @param param Method parameter.
+ */
+static ref_row_t ref_method_row(int32_t as_of, int32_t date, int method, int param) {
+    const ref_row_t invalid = {0, 0, 0, NAEGELES_ERR_INVALID_DATE};
+    if (!ref_valid_days(date)) {
+        return invalid;
+    }
+
+    int64_t origin = date, rule_date = 0;
+    switch (method) {
+        case NAEGELES_METHOD_NAEGELE:
+            rule_date = date + 7;
+            break;
+        case NAEGELES_METHOD_CYCLE:
+            if (param < 21 || param > 45) {
+                return invalid;
+            }
+            origin    = date + param - 28;
+            rule_date = origin + 7;
+            break;
+        case NAEGELES_METHOD_MITTENDORF:
+            rule_date = date + (param == 0 ? 15 : 10);
+            break;
+        case NAEGELES_METHOD_CONCEPTION:
+            return ref_woa_row(as_of, date - 14, date + 266);
+        case NAEGELES_METHOD_IVF:
+            if (param < 2 || param > 7) {
+                return invalid;
+            }
+            return ref_woa_row(as_of, date - 14 - param, date + 266 - param);
+        case NAEGELES_METHOD_CRL:
+        case NAEGELES_METHOD_BPD: {
+            const int16_t ga = (method == NAEGELES_METHOD_CRL ? ref.crl_ga : ref.bpd_ga)[param];
+            if (ga < 0) {
+                return invalid;
+            }
+            return ref_woa_row(as_of, date - ga, date - ga + 280);
+        }
+        default:
+            return invalid;
+    }
+
+    if (!ref_valid_days(origin) || !ref_valid_days(rule_date - 7)) {
+        return invalid;
+    }
+    return ref_woa_row(as_of, (int32_t)origin, ref_shift_months((int32_t)rule_date));
+}
+
+/**
+ * Returns the record length of a layout.
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ */
+static size_t ref_layout_length(int layout) {
+    return layout == NAEGELES_LAYOUT_COMPACT ? 8 : DATE_STR_LEN;
+}
+
+/** One thread's buffers and tallies; tallies are summed once every pass has run. */
+typedef struct {
+    uint64_t checked[CHECK_COUNT];
+    uint64_t failed[CHECK_COUNT];
+    int32_t* lnmp;
+    int32_t* edd;
+    int32_t* weeks;
+    int32_t* days;
+    int32_t* status;
+    size_t* rows;
+    uint8_t* method;
+    uint8_t* param;
+    uint8_t* valid;
+    char* records;
+} verify_worker_t;
+
+/** A pass body: checks one work unit. */
+typedef void (*verify_fn)(verify_worker_t* w, size_t unit);
+
+/** One pass: its body and its number of work units. */
+typedef struct {
+    verify_fn run;
+    size_t units;
+    verify_worker_t* worker;
+} verify_task_t;
+
+/** Next work unit of the running pass, shared by its threads. */
+static atomic_size_t verify_next;
+
+/** Guards verify_reports and the report lines. */
+static pthread_mutex_t verify_report_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Mismatches described so far. */
+static unsigned verify_reports;
+
+/** Extreme LNMPs appended to every spans batch, and the spans pass's extreme reference dates. */
+static const int32_t span_edges[] = {INT32_MIN, INT32_MIN + 1, -1000000,
+                                     1000000,   INT32_MAX - 7, INT32_MAX};
+
+/** Number of span_edges. */
+#define SPAN_EDGES (sizeof(span_edges) / sizeof(span_edges[0]))
+
+/**
+ * Returns the rows of a spans batch before the extreme values: every LNMP of the valid range and
+ * SPAN_MARGIN days on each side.
+ */
+static size_t span_rows(void) {
+    return (size_t)(ref.last_valid - ref.first_valid + 1 + 2 * SPAN_MARGIN);
+}
+
+/** Method and parameter pairs the offsets pass cycles through, including rejected ones. */
+static const uint8_t method_cases[][2] = {
+    {NAEGELES_METHOD_NAEGELE, 0},    {NAEGELES_METHOD_CYCLE, 28},
+    {NAEGELES_METHOD_CYCLE, 21},     {NAEGELES_METHOD_CYCLE, 45},
+    {NAEGELES_METHOD_CYCLE, 20},     {NAEGELES_METHOD_MITTENDORF, 0},
+    {NAEGELES_METHOD_MITTENDORF, 3}, {NAEGELES_METHOD_CONCEPTION, 0},
+    {NAEGELES_METHOD_IVF, 2},        {NAEGELES_METHOD_IVF, 7},
+    {NAEGELES_METHOD_IVF, 8},        {NAEGELES_METHOD_CRL, 10},
+    {NAEGELES_METHOD_CRL, 84},       {NAEGELES_METHOD_CRL, 85},
+    {NAEGELES_METHOD_BPD, 20},       {NAEGELES_METHOD_BPD, 100},
+    {NAEGELES_METHOD_BPD, 19},       {NAEGELES_METHOD_COUNT, 0},
+};
+
+/** Number of method_cases. */
+#define METHOD_CASES (sizeof(method_cases) / sizeof(method_cases[0]))
+
+/**
+ * Counts a mismatch and describes it on stderr while under VERIFY_MAX_REPORTS.
+ * @param w Worker.
+ * @param check CHECK_* index.
+ * @param format printf format of the description.
+ */
+__attribute__((format(printf, 3, 4))) static void verify_fail(verify_worker_t* w, int check,
+                                                               const char* format, ...) {
+    w->failed[check]++;
+
+    pthread_mutex_lock(&verify_report_lock);
+    if (verify_reports < VERIFY_MAX_REPORTS) {
+        verify_reports++;
+        va_list args;
+        va_start(args, format);
+        fprintf(stderr, "mismatch: %s: ", check_names[check]);
+        vfprintf(stderr, format, args);
+        fputc('\n', stderr);
+        va_end(args);
+    }
+    pthread_mutex_unlock(&verify_report_lock);
+}
+
+/**
+ * Compares a function's return code and NUL-terminated text output with the expected ones.
+ * @param w Worker.
+ * @param check CHECK_* index.
+ * @param input Input string, for the report.
+ * @param as_of Reference date, for the report.
+ * @param code Returned code.
+ * @param text Returned text.
+ * @param want_code Expected code.
+ * @param want_text Expected text.
+ */
+static void check_text(verify_worker_t* w, int check, const char* input, int32_t as_of, int code,
+                       const char* text, int want_code, const char* want_text) {
+    w->checked[check]++;
+    if (code != want_code || strcmp(text, want_text) != 0) {
+        verify_fail(w, check, "\"%s\" as_of %d: got %d \"%s\", expected %d \"%s\"", input,
+                    (int)as_of, code, text, want_code, want_text);
+    }
+}
+
+/**
+ * Compares rows of a batch output with their expected values.
+ * @param w Worker.
+ * @param check CHECK_* index.
+ * @param out Batch output.
+ * @param i Row index.
+ * @param want Expected row.
+ * @param input Input day number, for the report.
+ * @param as_of Reference date, for the report.
+ */
+static void check_row(verify_worker_t* w, int check, const naegeles_batch_t* out, size_t i,
+                      ref_row_t want, int32_t input, int32_t as_of) {
+    w->checked[check]++;
+    if (out->edd[i] != want.edd || out->woa_weeks[i] != want.weeks ||
+        out->woa_days[i] != want.days || out->status[i] != want.status) {
+        verify_fail(w, check,
+                    "row %zu lnmp %d as_of %d: got %d %d+%d status %d, expected %d %d+%d "
+                    "status %d",
+                    i, (int)input, (int)as_of, (int)out->edd[i], (int)out->woa_weeks[i],
+                    (int)out->woa_days[i], (int)out->status[i], (int)want.edd, (int)want.weeks,
+                    (int)want.days, (int)want.status);
+    }
+}
+
+/**
+ * Compares naegeles_compute_result_asof with the expected row.
+ * @param w Worker.
+ * @param text LNMP in dd/mm/yyyy form.
+ * @param as_of Reference date.
+ * @param row Expected row.
+ */
+static void check_result(verify_worker_t* w, const char* text, int32_t as_of, ref_row_t row) {
+    naegeles_result_t result;
+    naegeles_result_t want = {.status = row.status};
+    if (row.status != NAEGELES_ERR_INVALID_DATE) {
+        want.edd_day   = ref.day[row.edd + ref.epoch];
+        want.edd_month = ref.month[row.edd + ref.epoch];
+        want.edd_year  = ref.year[row.edd + ref.epoch];
+        want.woa_weeks = row.weeks;
+        want.woa_days  = row.days;
+    }
+
+    const int code = naegeles_compute_result_asof(text, as_of, &result);
+    w->checked[CHECK_COMPUTE_RESULT]++;
+    if (code != row.status || memcmp(&result, &want, sizeof(result)) != 0) {
+        verify_fail(w, CHECK_COMPUTE_RESULT,
+                    "\"%s\" as_of %d: got %d %02d/%02d/%04d %d+%d status %d, expected "
+                    "%02d/%02d/%04d %d+%d status %d",
+                    text, (int)as_of, code, result.edd_day, result.edd_month, result.edd_year,
+                    result.woa_weeks, result.woa_days, result.status, want.edd_day,
+                    want.edd_month, want.edd_year, want.woa_weeks, want.woa_days, want.status);
+    }
+}
+
+/**
+ * Compares a day-number result (parsers, naegeles_date_to_days) with the expected one.
+ * @param w Worker.
+ * @param check CHECK_* index.
+ * @param input Input text, for the report.
+ * @param code Returned code.
+ * @param days Returned day number (ignored unless code is NAEGELES_OK).
+ * @param valid Whether the input is valid.
+ * @param want Expected day number.
+ */
+static void check_days(verify_worker_t* w, int check, const char* input, int code, int32_t days,
+                       bool valid, int32_t want) {
+    w->checked[check]++;
+    const int want_code = valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE;
+    if (code != want_code || (valid && days != want)) {
+        verify_fail(w, check, "\"%s\": got %d day %d, expected %d day %d", input, code,
+                    (int)days, want_code, valid ? (int)want : 0);
+    }
+}
+
+/**
+ * Dates pass: every day 0-32 of months 0-13 of one year, in every layout, through every
+ * parser, and the civil conversions and EDD of the dates that exist.
+ * @param w Worker.
+ * @param unit Year index from DATES_FIRST_YEAR.
+ */
+static void verify_dates(verify_worker_t* w, size_t unit) {
+    const int year = DATES_FIRST_YEAR + (int)unit;
+
+    for (int layout = 0; layout < NAEGELES_LAYOUT_AUTO; layout++) {
+        const size_t len = ref_layout_length(layout);
+        size_t n         = 0;
+
+        for (int month = 0; month < DATES_MONTHS; month++) {
+            for (int day = 0; day < DATES_DAYS; day++, n++) {
+                char text[DATE_STR_MAX_LEN];
+                ref_format_civil(day, month, year, layout, text);
+                memcpy(w->records + n * len, text, len);
+
+                // Expected batch parser results: day number 0 for invalid records
+                const bool valid   = ref_valid(day, month, year);
+                const int32_t want = valid ? ref_days(day, month, year) : 0;
+                w->lnmp[n]         = want;
+                w->status[n]       = valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE;
+
+                int32_t days = 0;
+                int code = naegeles_parse_date_layout(text, len, (naegeles_date_layout_t)layout,
+                                                      &days);
+                check_days(w, CHECK_PARSE_LAYOUT, text, code, days, valid, want);
+                code = naegeles_parse_date_layout(text, len, NAEGELES_LAYOUT_AUTO, &days);
+                check_days(w, CHECK_PARSE_LAYOUT, text, code, days, valid, want);
+
+                w->checked[CHECK_DETECT_LAYOUT]++;
+                code = naegeles_detect_layout(text, len);
+                if (code != layout) {
+                    verify_fail(w, CHECK_DETECT_LAYOUT, "\"%s\": got %d, expected %d", text, code,
+                                layout);
+                }
+
+                if (layout != NAEGELES_LAYOUT_DMY_SLASH) {
+                    continue;
+                }
+
+                code = naegeles_parse_date(text, &days);
+                check_days(w, CHECK_PARSE_DATE, text, code, days, valid, want);
+                code = naegeles_date_to_days(day, month, year, &days);
+                check_days(w, CHECK_DATE_TO_DAYS, text, code, days, valid, want);
+
+                char edd[DATE_STR_MAX_LEN] = {0};
+                code = naegeles_compute_edd(text, edd, sizeof(edd));
+                check_text(w, CHECK_COMPUTE_EDD, text, 0, code, edd,
+                           valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE,
+                           valid ? ref.text[ref.edd[want + ref.epoch] + ref.epoch]
+                                 : "Invalid date");
+
+                if (!ref_exists(day, month, year)) {
+                    continue;
+                }
+
+                // Dates outside 1900-2100 still convert and format
+                const int32_t number    = ref_days(day, month, year);
+                char formatted[DATE_STR_MAX_LEN] = {0};
+                code = naegeles_format_date(number, formatted, DATE_STR_LEN);
+                check_text(w, CHECK_FORMAT_DATE, text, 0, code, formatted, DATE_STR_LEN, text);
+
+                int got_day = 0, got_month = 0, got_year = 0;
+                code = naegeles_days_to_date(number, &got_day, &got_month, &got_year);
+                w->checked[CHECK_DAYS_TO_DATE]++;
+                if (code != NAEGELES_OK || got_day != day || got_month != month ||
+                    got_year != year) {
+                    verify_fail(w, CHECK_DAYS_TO_DATE, "%d: got %d %02d/%02d/%04d, expected %s",
+                                (int)number, code, got_day, got_month, got_year, text);
+                }
+            }
+        }
+
+        // The same records back to back, as a fixed-width column without terminators
+        for (int pass = 0; pass < 2; pass++) {
+            const naegeles_date_layout_t as = pass == 0 ? (naegeles_date_layout_t)layout
+                                                        : NAEGELES_LAYOUT_AUTO;
+            int32_t* got_days   = w->days;
+            int32_t* got_status = w->weeks;
+            int code = naegeles_parse_batch_layout(w->records, len, n, as, got_days, got_status);
+            w->checked[CHECK_PARSE_BATCH] += n;
+            if (code != NAEGELES_OK) {
+                verify_fail(w, CHECK_PARSE_BATCH, "year %d layout %d: returned %d", year, (int)as,
+                            code);
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (got_status[i] != w->status[i] || got_days[i] != w->lnmp[i]) {
+                    verify_fail(w, CHECK_PARSE_BATCH,
+                                "\"%.*s\" layout %d: got %d day %d, expected %d day %d",
+                                (int)len, w->records + i * len, (int)as, (int)got_status[i],
+                                (int)got_days[i], (int)w->status[i], (int)w->lnmp[i]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Offsets pass: a block of reference dates, each against every LNMP from OFFSET_PAST_DAYS
+ * before it to OFFSET_FUTURE_DAYS after it, through the string API and the batch engines.
+ * @param w Worker.
+ * @param unit Block index.
+ */
+static void verify_offsets(verify_worker_t* w, size_t unit) {
+    const int32_t first_as_of = ref.first_valid - OFFSET_MARGIN;
+    const int32_t last_as_of  = ref.last_valid + OFFSET_PAST_DAYS + OFFSET_MARGIN;
+    const naegeles_batch_t out = {w->edd, w->weeks, w->days, w->status};
+
+    for (int32_t b = 0; b < OFFSET_BLOCK; b++) {
+        const int32_t as_of = first_as_of + (int32_t)unit * OFFSET_BLOCK + b;
+        if (as_of > last_as_of) {
+            break;
+        }
+
+        // The window in a scrambled order, repeated for the dedup engine's table path, plus
+        // two extreme rows; the first OFFSET_WINDOW rows hold each LNMP once
+        const size_t dedup_rows = OFFSET_REPEAT * OFFSET_WINDOW + 2;
+        for (size_t i = 0; i < OFFSET_REPEAT * OFFSET_WINDOW; i++) {
+            w->lnmp[i] = as_of - OFFSET_PAST_DAYS + (int32_t)(i * OFFSET_STEP % OFFSET_WINDOW);
+        }
+        w->lnmp[dedup_rows - 2] = INT32_MIN;
+        w->lnmp[dedup_rows - 1] = INT32_MAX;
+
+        naegeles_context_t ctx;
+        naegeles_context_init_asof(&ctx, as_of);
+
+        naegeles_compute_batch_ctx(&ctx, w->lnmp, OFFSET_WINDOW, &out);
+        for (size_t i = 0; i < OFFSET_WINDOW; i++) {
+            check_row(w, CHECK_BATCH_CTX, &out, i, ref_lnmp_row(as_of, w->lnmp[i]), w->lnmp[i],
+                      as_of);
+        }
+
+        naegeles_compute_batch_dedup(&ctx, w->lnmp, dedup_rows, &out);
+        for (size_t i = 0; i < dedup_rows; i++) {
+            check_row(w, CHECK_BATCH_DEDUP, &out, i, ref_lnmp_row(as_of, w->lnmp[i]), w->lnmp[i],
+                      as_of);
+        }
+
+        for (size_t i = 0; i < OFFSET_WINDOW; i++) {
+            const size_t c = (i + (uint32_t)as_of) % METHOD_CASES;
+            w->method[i]   = method_cases[c][0];
+            w->param[i]    = method_cases[c][1];
+        }
+        naegeles_compute_batch_methods(&ctx, w->lnmp, w->method, w->param, OFFSET_WINDOW, &out);
+        for (size_t i = 0; i < OFFSET_WINDOW; i++) {
+            check_row(w, CHECK_BATCH_METHODS, &out, i,
+                      ref_method_row(as_of, w->lnmp[i], w->method[i], w->param[i]), w->lnmp[i],
+                      as_of);
+        }
+
+        // String API, on the dd/mm/yyyy text of every LNMP of the window
+        for (size_t i = 0; i < OFFSET_WINDOW; i++) {
+            const int32_t lnmp  = w->lnmp[i];
+            const char* text    = ref.text[lnmp + ref.epoch];
+            const ref_row_t row = ref_lnmp_row(as_of, lnmp);
+            const bool valid    = row.status != NAEGELES_ERR_INVALID_DATE;
+            const char* edd     = valid ? ref.text[row.edd + ref.epoch] : "Invalid date";
+            const char* woa     = row.status == NAEGELES_OK ? ref.woa[as_of - lnmp]
+                                  : valid                   ? "LNMP is in the future"
+                                                            : "Invalid date";
+
+            char got_edd[DATE_STR_MAX_LEN] = {0}, got_woa[WOA_STR_MAX_LEN] = {0};
+            int code = naegeles_compute_asof(text, as_of, got_edd, sizeof(got_edd), got_woa,
+                                             sizeof(got_woa));
+            check_text(w, CHECK_COMPUTE_ASOF, text, as_of, code, got_edd, row.status, edd);
+            if (valid) {
+                check_text(w, CHECK_COMPUTE_ASOF, text, as_of, code, got_woa, row.status, woa);
+            }
+
+            memset(got_woa, 0, sizeof(got_woa));
+            code = naegeles_compute_woa_asof(text, as_of, got_woa, sizeof(got_woa));
+            check_text(w, CHECK_COMPUTE_WOA_ASOF, text, as_of, code, got_woa, row.status, woa);
+            check_result(w, text, as_of, row);
+        }
+    }
+}
+
+/**
+ * Spans pass: one sampled reference date against every LNMP of the valid range and its
+ * margins, plus extreme values, through the whole-batch engines (the per-row method engine with
+ * every method and parameter) and naegeles_select_changed.
+ * The last SPAN_EDGES units use the extreme values as reference dates.
+ * @param w Worker.
+ * @param unit Sample index.
+ */
+static void verify_spans(verify_worker_t* w, size_t unit) {
+    const int32_t as_of = unit < SPAN_SAMPLES
+                              ? ref.first_valid - SPAN_MARGIN + (int32_t)unit * SPAN_STRIDE
+                              : span_edges[unit - SPAN_SAMPLES];
+    const size_t count  = span_rows() + SPAN_EDGES;
+    const naegeles_batch_t out = {w->edd, w->weeks, w->days, w->status};
+
+    for (size_t i = 0; i < span_rows(); i++) {
+        w->lnmp[i] = ref.first_valid - SPAN_MARGIN + (int32_t)i;
+    }
+    memcpy(w->lnmp + span_rows(), span_edges, sizeof(span_edges));
+
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, as_of);
+
+    naegeles_compute_batch_ctx(&ctx, w->lnmp, count, &out);
+    for (size_t i = 0; i < count; i++) {
+        check_row(w, CHECK_BATCH_CTX, &out, i, ref_lnmp_row(as_of, w->lnmp[i]), w->lnmp[i],
+                  as_of);
+    }
+
+    naegeles_compute_batch_dedup(&ctx, w->lnmp, count, &out);
+    for (size_t i = 0; i < count; i++) {
+        check_row(w, CHECK_BATCH_DEDUP, &out, i, ref_lnmp_row(as_of, w->lnmp[i]), w->lnmp[i],
+                  as_of);
+    }
+
+    naegeles_compute_batch_parallel(&ctx, w->lnmp, count, &out, SPAN_PARALLEL_THREADS);
+    for (size_t i = 0; i < count; i++) {
+        check_row(w, CHECK_BATCH_PARALLEL, &out, i, ref_lnmp_row(as_of, w->lnmp[i]), w->lnmp[i],
+                  as_of);
+    }
+
+    // Every method (and the unknown one) with every parameter, at a different phase per unit
+    for (size_t i = 0; i < count; i++) {
+        w->method[i] = (uint8_t)((i + unit) % (NAEGELES_METHOD_COUNT + 1));
+        w->param[i]  = (uint8_t)(i / (NAEGELES_METHOD_COUNT + 1) + unit);
+    }
+    naegeles_compute_batch_methods(&ctx, w->lnmp, w->method, w->param, count, &out);
+    for (size_t i = 0; i < count; i++) {
+        check_row(w, CHECK_BATCH_METHODS, &out, i,
+                  ref_method_row(as_of, w->lnmp[i], w->method[i], w->param[i]), w->lnmp[i],
+                  as_of);
+    }
+
+    // The string result API at this reference date, for the ends of the valid range
+    const int32_t ends[] = {ref.first_valid, ref.last_valid};
+    for (size_t k = 0; k < sizeof(ends) / sizeof(ends[0]); k++) {
+        check_result(w, ref.text[ends[k] + ref.epoch], as_of, ref_lnmp_row(as_of, ends[k]));
+    }
+
+    // Previous reference dates 1 to 13 days before or after this one, towards zero at the
+    // extremes
+    const int32_t step       = 1 + (int32_t)(unit % 13);
+    const bool back          = as_of > INT32_MAX - step ||
+                      (unit % 2 == 0 && as_of >= INT32_MIN + step);
+    const int32_t prev_as_of = back ? as_of - step : as_of + step;
+    for (int change = NAEGELES_CHANGED_WEEKS; change <= NAEGELES_CHANGED_DAYS; change++) {
+        size_t changed = 0;
+        naegeles_select_changed(&ctx, prev_as_of, w->lnmp, count, (naegeles_change_t)change,
+                                w->rows, &changed);
+
+        // Changed rows are the ones whose reference results differ, in ascending order
+        size_t expected = 0;
+        bool listed     = true;
+        w->checked[CHECK_SELECT_CHANGED] += count;
+        for (size_t i = 0; i < count && listed; i++) {
+            const ref_row_t before = ref_lnmp_row(prev_as_of, w->lnmp[i]);
+            const ref_row_t after  = ref_lnmp_row(as_of, w->lnmp[i]);
+            if (before.status != after.status || before.weeks != after.weeks ||
+                (change == NAEGELES_CHANGED_DAYS && before.days != after.days)) {
+                listed = expected < changed && w->rows[expected] == i;
+                expected++;
+            }
+        }
+        if (!listed || expected != changed) {
+            verify_fail(w, CHECK_SELECT_CHANGED,
+                        "as_of %d since %d change %d: lists differ at entry %zu of %zu",
+                        (int)as_of, (int)prev_as_of, change, expected - !listed, changed);
+        }
+    }
+}
+
+/** Column names and formats naegeles_arrow_compute documents, in column order. */
+static const char* const arrow_names[ARROW_COLUMNS]   = {"edd", "woa_weeks", "woa_days", "status"};
+static const char* const arrow_formats[ARROW_COLUMNS] = {"tdD", "s", "s", "c"};
+
+/** Schema of the arrow pass's inputs. */
+static const struct ArrowSchema arrow_input_schema = {
+    .format = "tdD",
+    .name   = "lnmp",
+    .flags  = ARROW_FLAG_NULLABLE,
+};
+
+/**
+ * Release callback of the arrow pass's inputs, which own no memory.
+ * @param array Array to release.
+ */
+static void arrow_input_release(struct ArrowArray* array) {
+    array->release = NULL;
+}
+
+/**
+ * Tests bit i of an Arrow validity bitmap (least significant bit first).
+ * @param bitmap Bitmap bytes.
+ * @param i Bit index.
+ */
+static bool arrow_bit(const uint8_t* bitmap, int64_t i) {
+    return bitmap[i >> 3] >> (i & 7) & 1;
+}
+
+/**
+ * Checks the shape naegeles_arrow_compute documents: a struct schema and array of the four
+ * columns, each with a validity and a values buffer, all unsliced.
+ * @param schema Result schema.
+ * @param out Result array.
+ * @param length Expected rows.
+ * @return true if the shape matches.
+ */
+static bool arrow_layout_ok(const struct ArrowSchema* schema, const struct ArrowArray* out,
+                            int64_t length) {
+    bool ok = strcmp(schema->format, "+s") == 0 && schema->n_children == ARROW_COLUMNS &&
+              out->length == length && out->offset == 0 && out->n_buffers == 1 &&
+              out->n_children == ARROW_COLUMNS && out->buffers[0] != NULL;
+    for (int c = 0; ok && c < ARROW_COLUMNS; c++) {
+        const struct ArrowSchema* field = schema->children[c];
+        const struct ArrowArray* column = out->children[c];
+        ok = strcmp(field->format, arrow_formats[c]) == 0 &&
+             strcmp(field->name, arrow_names[c]) == 0 && field->flags == ARROW_FLAG_NULLABLE &&
+             field->n_children == 0 && column->length == length && column->offset == 0 &&
+             column->n_buffers == 2 && column->n_children == 0 && column->buffers[0] != NULL &&
+             column->buffers[1] != NULL;
+    }
+    return ok;
+}
+
+/**
+ * Runs naegeles_arrow_compute on an input over w->lnmp and compares every row, validity bit
+ * and null count with the batch output for the same rows. Then moves one column of the result
+ * and of its schema out, as a consumer keeping a single column would, releases the parents,
+ * and checks that the moved column stays readable until its own release.
+ * @param w Worker.
+ * @param ctx Reference date.
+ * @param in Input array; its values buffer is w->lnmp.
+ * @param batch naegeles_compute_batch_ctx output for every row of w->lnmp.
+ * @param moved Column moved out before the release, or ARROW_COLUMNS for none.
+ */
+static void check_arrow(verify_worker_t* w, const naegeles_context_t* ctx,
+                        const struct ArrowArray* in, const naegeles_batch_t* batch, int moved) {
+    struct ArrowSchema schema;
+    struct ArrowArray out;
+    const int32_t as_of = ctx->as_of;
+
+    w->checked[CHECK_ARROW_COMPUTE]++;
+    const int code = naegeles_arrow_compute(ctx, &arrow_input_schema, in, &schema, &out);
+    if (code != NAEGELES_OK) {
+        verify_fail(w, CHECK_ARROW_COMPUTE, "offset %lld as_of %d: returned %d",
+                    (long long)in->offset, (int)as_of, code);
+        return;
+    }
+    if (!arrow_layout_ok(&schema, &out, in->length)) {
+        verify_fail(w, CHECK_ARROW_COMPUTE, "offset %lld as_of %d: malformed result",
+                    (long long)in->offset, (int)as_of);
+        out.release(&out);
+        schema.release(&schema);
+        return;
+    }
+
+    const uint8_t* in_valid = in->buffers[0];
+    const uint8_t* valid[ARROW_BITMAPS] = {out.buffers[0]};
+    for (int c = 0; c < ARROW_COLUMNS; c++) {
+        valid[1 + c] = out.children[c]->buffers[0];
+    }
+    const int32_t* edd   = out.children[0]->buffers[1];
+    const int16_t* weeks = out.children[1]->buffers[1];
+    const int16_t* days  = out.children[2]->buffers[1];
+    const int8_t* status = out.children[3]->buffers[1];
+
+    int64_t nulls[ARROW_BITMAPS] = {0};
+    for (int64_t r = 0; r < in->length; r++) {
+        const int64_t j    = in->offset + r;
+        const bool present = in_valid == NULL || arrow_bit(in_valid, j);
+        int32_t want       = batch->status[j];
+        if (want == NAEGELES_OK && batch->woa_weeks[j] > INT16_MAX) {
+            want = NAEGELES_ERR_UNSUPPORTED;
+        }
+        const bool has_edd = present && (want == NAEGELES_OK || want == NAEGELES_ERR_FUTURE_DATE);
+        const bool has_woa = present && want == NAEGELES_OK;
+
+        // Values of null slots are unspecified, so only valid ones are compared
+        const bool want_valid[ARROW_BITMAPS] = {present, has_edd, has_woa, has_woa, present};
+        bool match = (!has_edd || edd[r] == batch->edd[j]) &&
+                     (!has_woa || (weeks[r] == batch->woa_weeks[j] &&
+                                   days[r] == batch->woa_days[j])) &&
+                     (!present || status[r] == want);
+        for (int c = 0; c < ARROW_BITMAPS; c++) {
+            nulls[c] += !want_valid[c];
+            match = match && arrow_bit(valid[c], r) == want_valid[c];
+        }
+
+        w->checked[CHECK_ARROW_COMPUTE]++;
+        if (!match) {
+            verify_fail(w, CHECK_ARROW_COMPUTE,
+                        "offset %lld row %lld lnmp %d as_of %d: got %d %d+%d status %d, "
+                        "expected %d %d+%d status %d (present %d)",
+                        (long long)in->offset, (long long)r, (int)w->lnmp[j], (int)as_of,
+                        (int)edd[r], (int)weeks[r], (int)days[r], (int)status[r],
+                        (int)batch->edd[j], (int)batch->woa_weeks[j], (int)batch->woa_days[j],
+                        (int)want, present);
+        }
+    }
+
+    w->checked[CHECK_ARROW_COMPUTE]++;
+    bool counted = out.null_count == nulls[0];
+    for (int c = 0; c < ARROW_COLUMNS; c++) {
+        counted = counted && out.children[c]->null_count == nulls[1 + c];
+    }
+    if (!counted) {
+        verify_fail(w, CHECK_ARROW_COMPUTE, "offset %lld as_of %d: wrong null counts",
+                    (long long)in->offset, (int)as_of);
+    }
+
+    // The parents release the columns still in place; the moved ones keep the buffers alive
+    struct ArrowArray column = {0};
+    struct ArrowSchema field = {0};
+    if (moved < ARROW_COLUMNS) {
+        column                          = *out.children[moved];
+        field                           = *schema.children[moved];
+        out.children[moved]->release    = NULL;
+        schema.children[moved]->release = NULL;
+    }
+    struct ArrowArray** children = out.children;
+    struct ArrowSchema** fields  = schema.children;
+    out.release(&out);
+    schema.release(&schema);
+
+    w->checked[CHECK_ARROW_COMPUTE]++;
+    bool released = out.release == NULL && schema.release == NULL;
+    if (moved < ARROW_COLUMNS) {
+        for (int c = 0; c < ARROW_COLUMNS; c++) {
+            released = released && children[c]->release == NULL && fields[c]->release == NULL;
+        }
+        int64_t column_nulls = 0;
+        for (int64_t r = 0; r < column.length; r++) {
+            column_nulls += !arrow_bit(column.buffers[0], r);
+        }
+        released = released && column_nulls == column.null_count &&
+                   strcmp(field.format, arrow_formats[moved]) == 0;
+        column.release(&column);
+        field.release(&field);
+        released = released && column.release == NULL && field.release == NULL;
+    }
+    if (!released) {
+        verify_fail(w, CHECK_ARROW_COMPUTE, "offset %lld as_of %d column %d: release failed",
+                    (long long)in->offset, (int)as_of, moved);
+    }
+}
+
+/**
+ * Checks that naegeles_arrow_compute rejects arguments it cannot read, and accepts an empty
+ * array.
+ * @param w Worker.
+ */
+static void verify_arrow_rejects(verify_worker_t* w) {
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, 0);
+    const void* buffers[2]       = {NULL, w->lnmp};
+    const struct ArrowArray good = {
+        .length    = 1,
+        .n_buffers = 2,
+        .buffers   = buffers,
+        .release   = arrow_input_release,
+    };
+    const struct ArrowSchema int32_schema = {.format = "i", .name = "lnmp"};
+
+    struct ArrowArray bad[4] = {good, good, good, good};
+    bad[0].release           = NULL;
+    bad[1].n_buffers         = 1;
+    bad[2].offset            = -1;
+    bad[3].length            = -1;
+    const struct {
+        const naegeles_context_t* ctx;
+        const struct ArrowSchema* schema;
+        const struct ArrowArray* in;
+        int code;
+    } cases[] = {
+        {NULL, &arrow_input_schema, &good, NAEGELES_ERR_NULL_PARAM},
+        {&ctx, NULL, &good, NAEGELES_ERR_NULL_PARAM},
+        {&ctx, &arrow_input_schema, NULL, NAEGELES_ERR_NULL_PARAM},
+        {&ctx, &arrow_input_schema, &bad[0], NAEGELES_ERR_NULL_PARAM},
+        {&ctx, &int32_schema, &good, NAEGELES_ERR_UNSUPPORTED},
+        {&ctx, &arrow_input_schema, &bad[1], NAEGELES_ERR_UNSUPPORTED},
+        {&ctx, &arrow_input_schema, &bad[2], NAEGELES_ERR_UNSUPPORTED},
+        {&ctx, &arrow_input_schema, &bad[3], NAEGELES_ERR_UNSUPPORTED},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        struct ArrowSchema schema = {0};
+        struct ArrowArray out     = {0};
+        w->checked[CHECK_ARROW_COMPUTE]++;
+        const int code = naegeles_arrow_compute(cases[i].ctx, cases[i].schema, cases[i].in,
+                                                &schema, &out);
+        if (code != cases[i].code || out.release != NULL || schema.release != NULL) {
+            verify_fail(w, CHECK_ARROW_COMPUTE, "rejected case %zu: got %d, expected %d", i,
+                        code, cases[i].code);
+        }
+    }
+
+    // An empty array needs no values buffer
+    const void* no_buffers[2]     = {NULL, NULL};
+    const struct ArrowArray empty = {
+        .n_buffers = 2,
+        .buffers   = no_buffers,
+        .release   = arrow_input_release,
+    };
+    const naegeles_batch_t batch = {w->edd, w->weeks, w->days, w->status};
+    check_arrow(w, &ctx, &empty, &batch, 0);
+}
+
+/**
+ * Arrow pass: one reference date against every LNMP of the spans pass through
+ * naegeles_arrow_compute, as an array without a validity bitmap, with scattered nulls, and as
+ * a slice of the one with nulls, compared with naegeles_compute_batch_ctx. The reference
+ * dates are sampled across the valid range, at the int16 week limit of the earliest valid
+ * LNMP, and the spans pass's extreme ones; the last unit checks rejected inputs instead.
+ * @param w Worker.
+ * @param unit Reference date index.
+ */
+static void verify_arrow(verify_worker_t* w, size_t unit) {
+    if (unit == ARROW_UNITS - 1) {
+        verify_arrow_rejects(w);
+        return;
+    }
+
+    const int32_t as_of = unit < ARROW_SAMPLES
+                              ? ref.first_valid - SPAN_MARGIN + (int32_t)unit * ARROW_STRIDE
+                          : unit == ARROW_SAMPLES ? ref.first_valid + 7 * (INT16_MAX + 1)
+                                                  : span_edges[unit - ARROW_SAMPLES - 1];
+    const size_t count           = span_rows() + SPAN_EDGES;
+    const naegeles_batch_t batch = {w->edd, w->weeks, w->days, w->status};
+
+    for (size_t i = 0; i < span_rows(); i++) {
+        w->lnmp[i] = ref.first_valid - SPAN_MARGIN + (int32_t)i;
+    }
+    memcpy(w->lnmp + span_rows(), span_edges, sizeof(span_edges));
+
+    // Every 11th row null, at a different phase per unit
+    int64_t nulls = 0;
+    memset(w->valid, 0, (count + 7) / 8);
+    for (size_t i = 0; i < count; i++) {
+        if ((i + unit) % 11 != 0) {
+            w->valid[i >> 3] |= (uint8_t)(1u << (i & 7));
+        } else {
+            nulls++;
+        }
+    }
+
+    naegeles_context_t ctx;
+    naegeles_context_init_asof(&ctx, as_of);
+    naegeles_compute_batch_ctx(&ctx, w->lnmp, count, &batch);
+
+    // The slice's null count is left unknown (-1), which the format allows
+    const int64_t offset    = ARROW_SLICE_OFFSET + (int64_t)unit;
+    const void* dense[2]    = {NULL, w->lnmp};
+    const void* nullable[2] = {w->valid, w->lnmp};
+    const struct ArrowArray inputs[3] = {
+        {.length = (int64_t)count, .n_buffers = 2, .buffers = dense},
+        {.length = (int64_t)count, .null_count = nulls, .n_buffers = 2, .buffers = nullable},
+        {.length     = (int64_t)count - offset,
+         .null_count = -1,
+         .offset     = offset,
+         .n_buffers  = 2,
+         .buffers    = nullable},
+    };
+    for (int k = 0; k < 3; k++) {
+        struct ArrowArray in = inputs[k];
+        in.release           = arrow_input_release;
+        check_arrow(w, &ctx, &in, &batch, (int)((unit + (size_t)k) % (ARROW_COLUMNS + 1)));
+    }
+}
+
+/**
+ * Checks naegeles_format_woa against ref_format_woa, with a roomy buffer, an exact one and
+ * one byte short.
+ * @param w Worker.
+ * @param weeks Completed weeks.
+ * @param days Remaining days.
+ */
+static void check_format_woa(verify_worker_t* w, int32_t weeks, int32_t days) {
+    char want[WOA_STR_MAX_LEN], got[WOA_STR_MAX_LEN];
+    const size_t len = ref_format_woa((uint32_t)weeks, (uint32_t)days, want);
+
+    const size_t sizes[3] = {sizeof(got), len, len - 1};
+    for (int s = 0; s < 3; s++) {
+        w->checked[CHECK_FORMAT_WOA]++;
+        const int code = naegeles_format_woa(weeks, days, got, sizes[s]);
+        const int want_code = s < 2 ? (int)len : NAEGELES_ERR_BUFFER_TOO_SMALL;
+        if (code != want_code || (code > 0 && memcmp(got, want, len) != 0)) {
+            verify_fail(w, CHECK_FORMAT_WOA, "%d+%d size %zu: got %d \"%.*s\", expected %d \"%s\"",
+                        (int)weeks, (int)days, sizes[s], code, code > 0 ? code : 0, got,
+                        want_code, want);
+        }
+    }
+}
+
+/**
+ * Checks naegeles_format_uint against snprintf, with a roomy buffer, an exact one and one byte
+ * short.
+ * @param w Worker.
+ * @param value Value to format.
+ */
+static void check_format_uint(verify_worker_t* w, uint32_t value) {
+    char want[16], got[16];
+    const size_t len = (size_t)snprintf(want, sizeof(want), "%u", value);
+
+    const size_t sizes[3] = {sizeof(got), len, len - 1};
+    for (int s = 0; s < 3; s++) {
+        w->checked[CHECK_FORMAT_UINT]++;
+        const int code = naegeles_format_uint(value, got, sizes[s]);
+        const int want_code = s < 2 ? (int)len : NAEGELES_ERR_BUFFER_TOO_SMALL;
+        if (code != want_code || (code > 0 && memcmp(got, want, len) != 0)) {
+            verify_fail(w, CHECK_FORMAT_UINT, "%u size %zu: got %d \"%.*s\", expected %d", value,
+                        sizes[s], code, code > 0 ? code : 0, got, want_code);
+        }
+    }
+}
+
+/**
+ * Text pass: a block of week counts with every day count and a block of integers, or (last
+ * unit) the extreme and invalid values.
+ * @param w Worker.
+ * @param unit Block index; TEXT_BLOCKS is the edge unit.
+ */
+static void verify_text(verify_worker_t* w, size_t unit) {
+    if (unit < TEXT_BLOCKS) {
+        for (int32_t i = 0; i < TEXT_WEEKS_PER_BLOCK; i++) {
+            for (int32_t days = 0; days < 7; days++) {
+                check_format_woa(w, (int32_t)unit * TEXT_WEEKS_PER_BLOCK + i, days);
+            }
+        }
+        for (uint32_t i = 0; i < TEXT_UINTS_PER_BLOCK; i++) {
+            check_format_uint(w, (uint32_t)unit * TEXT_UINTS_PER_BLOCK + i);
+        }
+        return;
+    }
+
+    for (uint32_t power = 10; power <= 1000000000u; power *= 10) {
+        check_format_uint(w, power - 1);
+        check_format_uint(w, power);
+        check_format_woa(w, (int32_t)power - 1, 6);
+        check_format_woa(w, (int32_t)power, 1);
+    }
+    check_format_uint(w, UINT32_MAX);
+    check_format_woa(w, INT32_MAX, 6);
+
+    char got[WOA_STR_MAX_LEN];
+    const int32_t bad[][2] = {{-1, 0}, {0, -1}, {0, 7}, {INT32_MIN, 0}};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        w->checked[CHECK_FORMAT_WOA]++;
+        const int code = naegeles_format_woa(bad[i][0], bad[i][1], got, sizeof(got));
+        if (code != NAEGELES_ERR_INVALID_DATE) {
+            verify_fail(w, CHECK_FORMAT_WOA, "%d+%d: got %d, expected %d", (int)bad[i][0],
+                        (int)bad[i][1], code, NAEGELES_ERR_INVALID_DATE);
+        }
+    }
+}
+
+/**
+ * Thread entry point: runs work units of the current pass until none are left.
+ * @param arg Pointer to a verify_task_t.
+ * @return NULL.
+ */
+static void* verify_task_run(void* arg) {
+    verify_task_t* task = arg;
+    for (size_t unit; (unit = atomic_fetch_add(&verify_next, 1)) < task->units;) {
+        task->run(task->worker, unit);
+    }
+    return NULL;
+}
+
+/**
+ * Runs one pass on every worker, inline for workers whose thread fails to start.
+ * @param workers Workers, one per thread.
+ * @param threads Number of workers.
+ * @param run Pass body.
+ * @param units Work units of the pass.
+ */
+static void verify_run_pass(verify_worker_t* workers, unsigned threads, verify_fn run,
+                            size_t units) {
+    pthread_t tids[NAEGELES_MAX_THREADS];
+    bool started[NAEGELES_MAX_THREADS];
+    verify_task_t tasks[NAEGELES_MAX_THREADS];
+
+    atomic_store(&verify_next, 0);
+    for (unsigned t = 0; t < threads; t++) {
+        tasks[t]   = (verify_task_t){run, units, &workers[t]};
+        started[t] = pthread_create(&tids[t], NULL, verify_task_run, &tasks[t]) == 0;
+        if (!started[t]) {
+            verify_task_run(&tasks[t]);
+        }
+    }
+    for (unsigned t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        }
+    }
+}
+
+/**
+ * Allocates a worker's buffers, sized for the largest batch of any pass.
+ * @param w Worker to fill.
+ * @return false if allocation failed.
+ */
+static bool verify_worker_init(verify_worker_t* w) {
+    const size_t rows = span_rows() + SPAN_EDGES;
+    *w                = (verify_worker_t){0};
+    w->lnmp           = malloc(rows * sizeof(int32_t));
+    w->edd            = malloc(rows * sizeof(int32_t));
+    w->weeks          = malloc(rows * sizeof(int32_t));
+    w->days           = malloc(rows * sizeof(int32_t));
+    w->status         = malloc(rows * sizeof(int32_t));
+    w->rows           = malloc(rows * sizeof(size_t));
+    w->method         = malloc(rows);
+    w->param          = malloc(rows);
+    w->valid          = malloc((rows + 7) / 8);
+    w->records        = malloc(DATES_RECORDS * DATE_STR_LEN);
+    return w->lnmp != NULL && w->edd != NULL && w->weeks != NULL && w->days != NULL &&
+           w->status != NULL && w->rows != NULL && w->method != NULL && w->param != NULL &&
+           w->valid != NULL && w->records != NULL;
+}
+
+/**
+ * Frees a worker's buffers.
+ * @param w Worker.
+ */
+static void verify_worker_free(verify_worker_t* w) {
+    free(w->lnmp);
+    free(w->edd);
+    free(w->weeks);
+    free(w->days);
+    free(w->status);
+    free(w->rows);
+    free(w->method);
+    free(w->param);
+    free(w->valid);
+    free(w->records);
+}
+
+/**
+ * Runs the self-check; see edd_verify.h.
+ * @param threads Worker threads (at least 1).
+ * @return 0 if every result matched the reference, 1 otherwise.
+ */
+int naegeles_verify(unsigned threads) {
+    threads = threads < 1 ? 1 : threads > NAEGELES_MAX_THREADS ? NAEGELES_MAX_THREADS : threads;
+    ref_init();
+
+    verify_worker_t* workers = calloc(threads, sizeof(*workers));
+    bool ok                  = workers != NULL;
+    for (unsigned t = 0; ok && t < threads; t++) {
+        ok = verify_worker_init(&workers[t]);
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: out of memory\n");
+        for (unsigned t = 0; workers != NULL && t < threads; t++) {
+            verify_worker_free(&workers[t]);
+        }
+        free(workers);
+        return 1;
+    }
+
+    const size_t as_of_count = (size_t)(ref.last_valid + OFFSET_PAST_DAYS + OFFSET_MARGIN) -
+                               (size_t)(ref.first_valid - OFFSET_MARGIN) + 1;
+    verify_run_pass(workers, threads, verify_dates, DATES_LAST_YEAR - DATES_FIRST_YEAR + 1);
+    verify_run_pass(workers, threads, verify_offsets,
+                    (as_of_count + OFFSET_BLOCK - 1) / OFFSET_BLOCK);
+    verify_run_pass(workers, threads, verify_spans, SPAN_SAMPLES + SPAN_EDGES);
+    verify_run_pass(workers, threads, verify_arrow, ARROW_UNITS);
+    verify_run_pass(workers, threads, verify_text, TEXT_BLOCKS + 1);
+
+    uint64_t failed = 0;
+    for (int c = 0; c < CHECK_COUNT; c++) {
+        uint64_t checked = 0, mismatched = 0;
+        for (unsigned t = 0; t < threads; t++) {
+            checked += workers[t].checked[c];
+            mismatched += workers[t].failed[c];
+        }
+        printf("%-32s %12llu checked %8llu mismatched\n", check_names[c],
+               (unsigned long long)checked, (unsigned long long)mismatched);
+        failed += mismatched;
+    }
+    failed += naegeles_verify_hpp();
+    printf("%s\n", failed == 0 ? "OK" : "FAILED");
+
+    for (unsigned t = 0; t < threads; t++) {
+        verify_worker_free(&workers[t]);
+    }
+    free(workers);
+    return failed == 0 ? 0 : 1;
+}
+
+#ifdef NAEGELES_FUZZ
+/** Reference date of the fuzz target's result checks (01/06/2024). */
+#define FUZZ_AS_OF 19875
+
+/**
+ * Parses a record the way edd.h documents the layouts: exact length, ASCII digits and
+ * separators in place, and a valid LNMP date.
+ * @param text Record bytes.
+ * @param len Record length.
+ * @param layout Record layout (not NAEGELES_LAYOUT_AUTO).
+ * @param days_out Output day number.
+ * @return true if the record is a valid LNMP.
+ */
+static bool ref_parse(const char* text, size_t len, int layout, int32_t* days_out) {
+    static const char* const shapes[NAEGELES_LAYOUT_AUTO] = {"dd/mm/yyyy", "dd-mm-yyyy",
+                                                              "yyyy-mm-dd", "yyyymmdd"};
+    const char* shape = shapes[layout];
+    if (len != strlen(shape)) {
+        return false;
+    }
+
+    int day = 0, month = 0, year = 0;
+    for (size_t i = 0; i < len; i++) {
+        const int c = (unsigned char)text[i];
+        if (shape[i] != 'd' && shape[i] != 'm' && shape[i] != 'y') {
+            if (c != shape[i]) {
+                return false;
+            }
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        int* field = shape[i] == 'd' ? &day : shape[i] == 'm' ? &month : &year;
+        *field     = *field * 10 + (c - '0');
+    }
+
+    if (!ref_valid(day, month, year)) {
+        return false;
+    }
+    *days_out = ref_days(day, month, year);
+    return true;
+}
+
+/**
+ * Returns the layout naegeles_detect_layout documents for a record: the separators of a
+ * 10-byte record (dd/mm/yyyy first), or eight digits for an 8-byte one.
+ * @param text Record bytes.
+ * @param len Record length.
+ * @return The layout, or NAEGELES_LAYOUT_AUTO if none fits.
+ */
+static int ref_detect(const char* text, size_t len) {
+    if (len == DATE_STR_LEN) {
+        if (text[2] == '/' && text[5] == '/') {
+            return NAEGELES_LAYOUT_DMY_SLASH;
+        }
+        if (text[2] == '-' && text[5] == '-') {
+            return NAEGELES_LAYOUT_DMY_DASH;
+        }
+        if (text[4] == '-' && text[7] == '-') {
+            return NAEGELES_LAYOUT_ISO;
+        }
+        return NAEGELES_LAYOUT_AUTO;
+    }
+    if (len != 8) {
+        return NAEGELES_LAYOUT_AUTO;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return NAEGELES_LAYOUT_AUTO;
+        }
+    }
+    return NAEGELES_LAYOUT_COMPACT;
+}
+
+/**
+ * Describes a fuzz mismatch and aborts, so libFuzzer keeps the input as a crash.
+ * @param format printf format of the description.
+ */
+__attribute__((format(printf, 1, 2), noreturn)) static void fuzz_fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "mismatch: ");
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+    abort();
+}
+
+/**
+ * libFuzzer entry point: parses the input as one record in every layout (and detected), as
+ * back-to-back records of every layout, and as a NUL-terminated dd/mm/yyyy string, and aborts
+ * on any difference from the reference parser.
+ * @param data Input bytes.
+ * @param size Input length.
+ * @return 0.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    ref_init();
+    const char* text = (const char*)data;
+
+    const int detected = ref_detect(text, size);
+    const int code     = naegeles_detect_layout(text, size);
+    if (code != (detected == NAEGELES_LAYOUT_AUTO ? NAEGELES_ERR_INVALID_DATE : detected)) {
+        fuzz_fail("naegeles_detect_layout: got %d, expected layout %d", code, detected);
+    }
+
+    for (int layout = 0; layout <= NAEGELES_LAYOUT_AUTO; layout++) {
+        const int as     = layout == NAEGELES_LAYOUT_AUTO ? detected : layout;
+        int32_t want     = 0, days = 0;
+        const bool valid = as != NAEGELES_LAYOUT_AUTO && ref_parse(text, size, as, &want);
+        const int parsed =
+            naegeles_parse_date_layout(text, size, (naegeles_date_layout_t)layout, &days);
+        if (parsed != (valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE) ||
+            (valid && days != want)) {
+            fuzz_fail("naegeles_parse_date_layout %d: got %d day %d, expected %d day %d", layout,
+                      parsed, (int)days, valid, (int)want);
+        }
+    }
+
+    // Whole records of each layout, back to back
+    int32_t* days   = malloc((size / 8 + 1) * sizeof(int32_t));
+    int32_t* status = malloc((size / 8 + 1) * sizeof(int32_t));
+    char* string    = malloc(size + 1);
+    if (days == NULL || status == NULL || string == NULL) {
+        abort();
+    }
+    for (int layout = 0; layout < NAEGELES_LAYOUT_AUTO; layout++) {
+        const size_t len   = ref_layout_length(layout);
+        const size_t count = size / len;
+        naegeles_parse_batch_layout(text, len, count, (naegeles_date_layout_t)layout, days,
+                                    status);
+        for (size_t i = 0; i < count; i++) {
+            int32_t want     = 0;
+            const bool valid = ref_parse(text + i * len, len, layout, &want);
+            if (status[i] != (valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE) ||
+                days[i] != want) {
+                fuzz_fail("naegeles_parse_batch_layout %d row %zu: got %d day %d, expected %d "
+                          "day %d", layout, i, (int)status[i], (int)days[i], valid, (int)want);
+            }
+        }
+    }
+
+    // The string API stops at the first NUL
+    memcpy(string, data, size);
+    string[size] = '\0';
+    int32_t want = 0, got = 0;
+    const bool valid = ref_parse(string, strlen(string), NAEGELES_LAYOUT_DMY_SLASH, &want);
+    const int parsed = naegeles_parse_date(string, &got);
+    if (parsed != (valid ? NAEGELES_OK : NAEGELES_ERR_INVALID_DATE) || (valid && got != want)) {
+        fuzz_fail("naegeles_parse_date: got %d day %d, expected %d day %d", parsed, (int)got,
+                  valid, (int)want);
+    }
+
+    naegeles_result_t result;
+    const ref_row_t row = valid ? ref_lnmp_row(FUZZ_AS_OF, want)
+                                : (ref_row_t){0, 0, 0, NAEGELES_ERR_INVALID_DATE};
+    const int computed  = naegeles_compute_result_asof(string, FUZZ_AS_OF, &result);
+    if (computed != row.status || result.status != row.status ||
+        (valid && (result.edd_day != ref.day[row.edd + ref.epoch] ||
+                   result.edd_month != ref.month[row.edd + ref.epoch] ||
+                   result.edd_year != ref.year[row.edd + ref.epoch] ||
+                   result.woa_weeks != row.weeks || result.woa_days != row.days))) {
+        fuzz_fail("naegeles_compute_result_asof: got %d %02d/%02d/%04d %d+%d, expected %d",
+                  computed, result.edd_day, result.edd_month, result.edd_year, result.woa_weeks,
+                  result.woa_days, row.status);
+    }
+
+    free(days);
+    free(status);
+    free(string);
+    return 0;
+}
+#else
+/**
+ * Entry point of the edd_verify test binary (./build.sh test).
+ * @param argc Argument count.
+ * @param argv Argument vector: optionally --threads N (0 = one per CPU, the default).
+ * @return 0 if every check passed, 1 on a mismatch or a usage error.
+ */
+int main(int argc, char* argv[]) {
+    unsigned threads = 0;
+    for (int i = 1; i < argc; i++) {
+        char* end = NULL;
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (unsigned)strtoul(argv[++i], &end, 10);
+        }
+        if (end == NULL || *end != '\0') {
+            fprintf(stderr, "Usage: %s [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+    return naegeles_verify(naegeles_resolve_threads(threads));
+}
+#endif  // NAEGELES_FUZZ
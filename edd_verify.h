@@ -0,0 +1,65 @@
+/**
+ * Self-check of the library (edd_verify.c, built as the edd_verify test binary by
+ * ./build.sh test): an exhaustive differential run of every fast path in edd.c against an
+ * independent reference, and a libFuzzer entry point for the parsers.
+ *
+ * The reference builds its own calendar by walking every day from 1898 to 2103 one at a time
+ * and applies Naegele's rule to it; strings come from snprintf. Nothing is shared with edd.c,
+ * so a bug in its tables, SWAR parsers, digit-pair formatting or vector kernels cannot hide
+ * behind the same bug in the reference. The run covers:
+ *
+ *   dates    every day 0-32 of months 0-13 of 1899-2101, in every layout, through the string
+ *            and layout parsers, the batch parser, naegeles_format_date and naegeles_compute_edd
+ *   offsets  every reference date from late 1899 to early 2102 against every LNMP 46 weeks
+ *            before to 2 weeks after it, through the string API, the batch kernel, the dedup
+ *            and per-row method engines
+ *   spans    sampled reference dates up to the end of the vector kernel's WOA range, and
+ *            extreme ones, against every LNMP, padded with extreme values, through the batch,
+ *            dedup and parallel engines, the method engine with every method and parameter,
+ *            naegeles_select_changed and the result API
+ *   arrow    sampled, int16-limit and extreme reference dates against the same LNMPs through
+ *            naegeles_arrow_compute, unsliced and sliced, with and without nulls: every row,
+ *            validity bit and null count against the batch kernel, the release callbacks with
+ *            a column moved out, and rejected inputs
+ *   text     naegeles_format_woa and naegeles_format_uint, including buffer-size edges
+ *
+ * Build edd.c with -DNAEGELES_EDD_LUT, -DNAEGELES_NO_SIMD or -DNAEGELES_STATS (CFLAGS for
+ * ./build.sh test) to verify those builds; the runtime-dispatched AVX2 kernels are used when the
+ * CPU has them.
+ *
+ * edd_verify_hpp.cpp runs every function of edd.hpp, the header-only C++ layer, against the C
+ * API it mirrors on the same inputs, as part of the same run.
+ *
+ * Built with -DNAEGELES_FUZZ (./build.sh fuzz), edd_verify.c also defines
+ * LLVMFuzzerTestOneInput: every input is parsed as one record in each layout, as a batch of
+ * records, and as a NUL-terminated string, and compared with the same reference.
+ */
+#ifndef EDD_VERIFY_H
+#define EDD_VERIFY_H
+
+#include <stdint.h>  // for uint64_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs the self-check, printing one line per checked function to stdout and the first
+ * mismatches to stderr.
+ * @param threads Worker threads (at least 1).
+ * @return 0 if every result matched the reference, 1 otherwise.
+ */
+int naegeles_verify(unsigned threads);
+
+/**
+ * Runs the edd.hpp checks (edd_verify_hpp.cpp), printing one line per checked function like
+ * naegeles_verify; called by it.
+ * @return Number of mismatches.
+ */
+uint64_t naegeles_verify_hpp(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // EDD_VERIFY_H
@@ -0,0 +1,306 @@
+/**
+ * edd.hpp half of edd_verify: every function of the header-only C++ layer, evaluated at run
+ * time, against the C API it mirrors on the same inputs; see edd_verify.h.
+ *
+ * The C library is the reference here. edd_verify.c checks the C library against its own
+ * independent calendar on a superset of these inputs, so a wrapper that agrees with it is right.
+ */
+#include <cstdarg>      // for va_list, va_start, va_end
+#include <cstdint>      // for int32_t, uint64_t, INT32_MIN, INT32_MAX
+#include <cstdio>       // for std::printf, std::fprintf, std::fputc, std::snprintf, std::vfprintf
+#include <cstring>      // for std::memcmp, std::memcpy, std::strcmp
+#include <string_view>  // for std::string_view
+
+#include "edd.hpp"
+#include "edd_verify.h"
+
+namespace {
+
+/** Years of the dates pass, one past each end of the valid range. */
+constexpr int first_year = naegeles::min_year - 1;
+constexpr int last_year  = naegeles::max_year + 1;
+
+/** Day and month fields of the dates pass: 0 to one past the largest real value. */
+constexpr int max_day   = 32;
+constexpr int max_month = 13;
+
+/** Every this many dates of the dates pass is also checked with each byte mutated. */
+constexpr int mutate_stride = 37;
+
+/** Bytes written over each position of a mutated date. */
+constexpr char mutations[] = {'0', '9', '/', '-', ' ', 'a', '\0', '\x80'};
+
+/** LNMPs of the day-number pass past each end of the valid range. */
+constexpr int32_t span_margin = 400;
+
+/** Distance between the reference dates of the day-number pass (prime). */
+constexpr int32_t as_of_stride = 1009;
+
+/** Extreme values, appended to the day-number pass as LNMPs and as reference dates. */
+constexpr int32_t edges[] = {INT32_MIN, INT32_MIN + 1, -1000000, 1000000, INT32_MAX - 7, INT32_MAX};
+
+/** Number of edges. */
+constexpr size_t edge_count = sizeof(edges) / sizeof(edges[0]);
+
+/** Rows of the day-number pass. */
+constexpr size_t span_rows = static_cast<size_t>(naegeles::max_day_number -
+                                                 naegeles::min_day_number + 1 + 2 * span_margin) +
+                             edge_count;
+
+/** First and last day numbers with four-digit years (0000-01-01 and 9999-12-31). */
+constexpr int32_t format_first = naegeles::days_from_civil(naegeles::date{1, 1, 0});
+constexpr int32_t format_last  = naegeles::days_from_civil(naegeles::date{31, 12, 9999});
+
+/** Mismatches described on stderr; the rest are only counted. */
+constexpr unsigned max_reports = 20;
+
+/** Checked functions of edd.hpp. */
+enum {
+    CHECK_PARSE_DATE,
+    CHECK_DAYS_FROM_CIVIL,
+    CHECK_CIVIL_FROM_DAYS,
+    CHECK_EDD,
+    CHECK_EDD_DAYS_TEXT,
+    CHECK_EDD_DAYS,
+    CHECK_WOA_AT,
+    CHECK_FORMAT_DATE,
+    CHECK_COUNT
+};
+
+/** Report names of the checks. */
+constexpr const char* check_names[CHECK_COUNT] = {
+    "naegeles::parse_date",
+    "naegeles::days_from_civil",
+    "naegeles::civil_from_days",
+    "naegeles::edd",
+    "naegeles::edd_days (string)",
+    "naegeles::edd_days (day number)",
+    "naegeles::woa_at",
+    "naegeles::format_date",
+};
+
+/** Tallies of the run. */
+struct tally {
+    uint64_t checked[CHECK_COUNT];
+    uint64_t failed[CHECK_COUNT];
+    unsigned reports;
+};
+
+/** Batch buffers of the day-number pass. */
+int32_t span_lnmp[span_rows], span_edd[span_rows], span_weeks[span_rows], span_days[span_rows],
+    span_status[span_rows];
+
+/**
+ * Counts a mismatch and describes it on stderr while under max_reports.
+ * @param t Tallies.
+ * @param check CHECK_* index.
+ * @param format printf format of the description.
+ */
+__attribute__((format(printf, 3, 4))) void fail(tally& t, int check, const char* format, ...) {
+    t.failed[check]++;
+    if (t.reports < max_reports) {
+        t.reports++;
+        va_list args;
+        va_start(args, format);
+        std::fprintf(stderr, "mismatch: %s: ", check_names[check]);
+        std::vfprintf(stderr, format, args);
+        std::fputc('\n', stderr);
+        va_end(args);
+    }
+}
+
+/**
+ * Compares naegeles::parse_date with naegeles_parse_date_layout on one string.
+ * @param t Tallies.
+ * @param text Input bytes.
+ * @param len Input length.
+ */
+void check_parse(tally& t, const char* text, size_t len) {
+    int32_t want = 0;
+    const int code = naegeles_parse_date_layout(text, len, NAEGELES_LAYOUT_DMY_SLASH, &want);
+    const naegeles::day_result got = naegeles::parse_date(std::string_view(text, len));
+
+    t.checked[CHECK_PARSE_DATE]++;
+    if (got.status != code || (code == NAEGELES_OK && got.days != want)) {
+        fail(t, CHECK_PARSE_DATE, "\"%.*s\": got %d day %d, expected %d day %d", (int)len, text,
+             (int)got.status, (int)got.days, code, (int)want);
+    }
+}
+
+/**
+ * Writes a date with naegeles::format_date and adds the terminator.
+ * @param d Date (years 0-9999).
+ * @param out Output with room for DATE_STR_MAX_LEN bytes.
+ */
+void format(naegeles::date d, char* out) {
+    naegeles::format_date(d, out);
+    out[DATE_STR_LEN] = '\0';
+}
+
+/**
+ * Dates pass: every day 0-32 of months 0-13 of 1899-2101 as dd/mm/yyyy text and as fields,
+ * through the parser, the civil conversion and both EDD overloads; every mutate_stride-th one
+ * also with each byte replaced and with its length off by one.
+ * @param t Tallies.
+ */
+void verify_dates(tally& t) {
+    int index = 0;
+    for (int year = first_year; year <= last_year; year++) {
+        for (int month = 0; month <= max_month; month++) {
+            for (int day = 0; day <= max_day; day++, index++) {
+                char text[DATE_STR_MAX_LEN] = {0};
+                std::snprintf(text, sizeof(text), "%02u/%02u/%04u", (unsigned)day % 100,
+                              (unsigned)month % 100, (unsigned)year % 10000);
+                check_parse(t, text, DATE_STR_LEN);
+
+                // Civil conversion; validity must match naegeles_date_to_days
+                const naegeles::date d{day, month, year};
+                int32_t want_days = 0;
+                const int code    = naegeles_date_to_days(day, month, year, &want_days);
+                const bool valid  = naegeles::is_valid_date(d);
+                t.checked[CHECK_DAYS_FROM_CIVIL]++;
+                if (valid != (code == NAEGELES_OK) ||
+                    (valid && naegeles::days_from_civil(d) != want_days)) {
+                    fail(t, CHECK_DAYS_FROM_CIVIL, "%s: got valid %d day %d, expected %d day %d",
+                         text, valid, valid ? (int)naegeles::days_from_civil(d) : 0, code,
+                         (int)want_days);
+                }
+
+                // Both EDD overloads against naegeles_compute_edd's text
+                char want_edd[DATE_STR_MAX_LEN] = {0}, got_edd[DATE_STR_MAX_LEN] = {0};
+                const int edd_code = naegeles_compute_edd(text, want_edd, sizeof(want_edd));
+                const naegeles::day_result edd = naegeles::edd_days(std::string_view(text));
+                if (edd.status == NAEGELES_OK) {
+                    format(naegeles::civil_from_days(edd.days), got_edd);
+                }
+                t.checked[CHECK_EDD_DAYS_TEXT]++;
+                if (edd.status != edd_code ||
+                    (edd_code == NAEGELES_OK && std::strcmp(got_edd, want_edd) != 0)) {
+                    fail(t, CHECK_EDD_DAYS_TEXT, "%s: got %d \"%s\", expected %d \"%s\"", text,
+                         (int)edd.status, got_edd, edd_code, want_edd);
+                }
+                if (valid) {
+                    format(naegeles::edd(d), got_edd);
+                    t.checked[CHECK_EDD]++;
+                    if (std::strcmp(got_edd, want_edd) != 0) {
+                        fail(t, CHECK_EDD, "%s: got \"%s\", expected \"%s\"", text, got_edd,
+                             want_edd);
+                    }
+                }
+
+                if (index % mutate_stride != 0) {
+                    continue;
+                }
+                for (size_t pos = 0; pos < DATE_STR_LEN; pos++) {
+                    for (char c : mutations) {
+                        char mutated[DATE_STR_MAX_LEN];
+                        std::memcpy(mutated, text, sizeof(mutated));
+                        mutated[pos] = c;
+                        check_parse(t, mutated, DATE_STR_LEN);
+                    }
+                }
+                text[DATE_STR_LEN]     = '0';
+                text[DATE_STR_LEN + 1] = '\0';
+                check_parse(t, text, DATE_STR_LEN - 1);
+                check_parse(t, text, DATE_STR_LEN + 1);
+            }
+        }
+    }
+}
+
+/**
+ * Day-number pass: every LNMP of the valid range and its margins, plus the edges, against
+ * sampled and extreme reference dates through naegeles_compute_batch_ctx.
+ * @param t Tallies.
+ */
+void verify_day_numbers(tally& t) {
+    const size_t margins = span_rows - edge_count;
+    for (size_t i = 0; i < margins; i++) {
+        span_lnmp[i] = naegeles::min_day_number - span_margin + static_cast<int32_t>(i);
+    }
+    for (size_t k = 0; k < edge_count; k++) {
+        span_lnmp[margins + k] = edges[k];
+    }
+
+    const naegeles_batch_t out = {span_edd, span_weeks, span_days, span_status};
+    const int32_t last_as_of   = naegeles::max_day_number + span_margin;
+    const size_t samples       = static_cast<size_t>(last_as_of - span_lnmp[0]) / as_of_stride + 1;
+
+    for (size_t s = 0; s < samples + edge_count; s++) {
+        const int32_t as_of = s < samples ? span_lnmp[0] + static_cast<int32_t>(s) * as_of_stride
+                                          : edges[s - samples];
+        naegeles_context_t ctx;
+        naegeles_context_init_asof(&ctx, as_of);
+        naegeles_compute_batch_ctx(&ctx, span_lnmp, span_rows, &out);
+
+        for (size_t i = 0; i < span_rows; i++) {
+            const int32_t lnmp             = span_lnmp[i];
+            const naegeles::woa_result got = naegeles::woa_at(lnmp, as_of);
+            t.checked[CHECK_WOA_AT]++;
+            if (got.status != span_status[i] || got.value.weeks != span_weeks[i] ||
+                got.value.days != span_days[i]) {
+                fail(t, CHECK_WOA_AT,
+                     "lnmp %d as_of %d: got %d+%d status %d, expected %d+%d status %d", (int)lnmp,
+                     (int)as_of, got.value.weeks, got.value.days, (int)got.status,
+                     (int)span_weeks[i], (int)span_days[i], (int)span_status[i]);
+            }
+
+            // The EDD is the same at every reference date, so it is checked once
+            if (s == 0 && naegeles::is_valid_day_number(lnmp)) {
+                t.checked[CHECK_EDD_DAYS]++;
+                if (naegeles::edd_days(lnmp) != span_edd[i]) {
+                    fail(t, CHECK_EDD_DAYS, "lnmp %d: got %d, expected %d", (int)lnmp,
+                         (int)naegeles::edd_days(lnmp), (int)span_edd[i]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Calendar pass: every day of years 0-9999 through naegeles::civil_from_days and
+ * naegeles::format_date, against naegeles_days_to_date and naegeles_format_date.
+ * @param t Tallies.
+ */
+void verify_calendar(tally& t) {
+    for (int32_t days = format_first; days <= format_last; days++) {
+        const naegeles::date got = naegeles::civil_from_days(days);
+        naegeles::date want{0, 0, 0};
+        naegeles_days_to_date(days, &want.day, &want.month, &want.year);
+        t.checked[CHECK_CIVIL_FROM_DAYS]++;
+        if (got != want) {
+            fail(t, CHECK_CIVIL_FROM_DAYS, "day %d: got %02d/%02d/%04d, expected %02d/%02d/%04d",
+                 (int)days, got.day, got.month, got.year, want.day, want.month, want.year);
+        }
+
+        char got_text[DATE_STR_MAX_LEN] = {0}, want_text[DATE_STR_MAX_LEN] = {0};
+        format(got, got_text);
+        naegeles_format_date(days, want_text, sizeof(want_text));
+        t.checked[CHECK_FORMAT_DATE]++;
+        if (std::memcmp(got_text, want_text, DATE_STR_LEN) != 0) {
+            fail(t, CHECK_FORMAT_DATE, "day %d: got \"%s\", expected \"%s\"", (int)days, got_text,
+                 want_text);
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * Runs the edd.hpp checks; see edd_verify.h.
+ * @return Number of mismatches.
+ */
+uint64_t naegeles_verify_hpp(void) {
+    tally t{};
+    verify_dates(t);
+    verify_day_numbers(t);
+    verify_calendar(t);
+
+    uint64_t failed = 0;
+    for (int c = 0; c < CHECK_COUNT; c++) {
+        std::printf("%-32s %12llu checked %8llu mismatched\n", check_names[c],
+                    (unsigned long long)t.checked[c], (unsigned long long)t.failed[c]);
+        failed += t.failed[c];
+    }
+    return failed;
+}